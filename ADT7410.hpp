@@ -9,19 +9,126 @@
  * file:        ADT7410.hpp
  */
 
+#ifndef ADT7410_HPP
+#define ADT7410_HPP
+
 #include <cinttypes>
 
-/* Derive from class ADT7410_Base and implement the read and write functions! */
+/* Position of the lowest set bit of a field mask, evaluated at compile time */
+template<uint16_t mask>
+struct ADT7410_Shift
+{
+	enum { value = (mask & 1) ? 0 : 1 + ADT7410_Shift<(mask >> 1)>::value };
+};
 
-/* ADT7410: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor */
-class ADT7410_Base
+template<>
+struct ADT7410_Shift<0>
 {
-public:
-	/* Pure virtual functions that need to be implemented in derived class: */
-	virtual uint8_t read8(uint16_t address, uint16_t n=8) = 0;  // 8 bit read
-	virtual void write(uint16_t address, uint8_t value, uint16_t n=8) = 0;  // 8 bit write
-	virtual uint16_t read16(uint16_t address, uint16_t n=16) = 0;  // 16 bit read
-	virtual void write(uint16_t address, uint16_t value, uint16_t n=16) = 0;  // 16 bit write
+	enum { value = 0 };
+};
+
+/* Register map: addresses, fields, defaults and field access, independent of the transport */
+struct ADT7410_Registers
+{
+	/****************************************************************************************************\
+	 *                                                                                                  *
+	 *                                           FIELD ACCESS                                           *
+	 *                                                                                                  *
+	\****************************************************************************************************/
+	
+	/*
+	 * FIELD ACCESS:
+	 * The shift of a field is derived from its mask at compile time, so every access
+	 * is a single and/shift:
+	 *   uint8_t mode = get<Configuration::OPMODE>(raw);
+	 *   raw = set<Configuration::RESOLUTION>(raw, Configuration::RESOLUTION::RES_16_BIT);
+	 *   raw = modify<Configuration::OPMODE>(Configuration::OPMODE::ONE_SHOT)
+	 *         .set<Configuration::RESOLUTION>(Configuration::RESOLUTION::RES_16_BIT)
+	 *         .apply(raw);
+	 */
+	
+	/* Get field F from a raw register value */
+	template<class F>
+	static uint16_t get(uint16_t raw)
+	{
+		return uint16_t((raw & F::mask) >> ADT7410_Shift<F::mask>::value);
+	}
+	
+	/* Set field F in a raw register value */
+	template<class F>
+	static uint16_t set(uint16_t raw, uint16_t value)
+	{
+		return uint16_t((raw & ~F::mask) | ((value << ADT7410_Shift<F::mask>::value) & F::mask));
+	}
+	
+	/* Several field updates of one register, applied at once */
+	class Modify
+	{
+	public:
+		Modify()
+			: mask(0), bits(0)
+		{
+		}
+		
+		template<class F>
+		Modify &set(uint16_t value)
+		{
+			mask |= F::mask;
+			bits = uint16_t((bits & ~F::mask) | ((value << ADT7410_Shift<F::mask>::value) & F::mask));
+			return *this;
+		}
+		
+		uint16_t apply(uint16_t raw) const
+		{
+			return uint16_t((raw & ~mask) | bits);
+		}
+		
+		/* Bits touched by the update */
+		uint16_t getMask() const
+		{
+			return mask;
+		}
+		
+		/* New content of the touched bits */
+		uint16_t getBits() const
+		{
+			return bits;
+		}
+		
+	private:
+		uint16_t mask;
+		uint16_t bits;
+	};
+	
+	/* Start a multi-field update with field F */
+	template<class F>
+	static Modify modify(uint16_t value)
+	{
+		return Modify().set<F>(value);
+	}
+	
+	
+	/****************************************************************************************************\
+	 *                                                                                                  *
+	 *                                              TIMING                                              *
+	 *                                                                                                  *
+	\****************************************************************************************************/
+	
+	/*
+	 * TIMING:
+	 * Nominal timings from the datasheet, in nanoseconds, shared by the samplers,
+	 * the simulator and everything that waits for the device.
+	 */
+	
+	/* Conversion time in continuous conversion and one-shot mode (typically 240 ms) */
+	static const uint64_t CONVERSION_TIME = 240000000u;
+	
+	/* 1 SPS mode: a conversion of about 60 ms once per second */
+	static const uint64_t ONE_SPS_CONVERSION_TIME = 60000000u;
+	static const uint64_t ONE_SPS_PERIOD = 1000000000u;
+	
+	/* Time the device NACKs after RESET (approximately 200 µs, with margin) */
+	static const uint64_t RESET_TIME = 250000u;
 	
 	
 	/****************************************************************************************************\
@@ -91,18 +198,6 @@ public:
 		};
 	};
 	
-	/* Set register TEMPERATURE */
-	void setTEMPERATURE(uint16_t value)
-	{
-		write(TEMPERATURE::__address, value, 16);
-	}
-	
-	/* Get register TEMPERATURE */
-	uint16_t getTEMPERATURE()
-	{
-		return read16(TEMPERATURE::__address, 16);
-	}
-	
 	
 	/*****************************************************************************************************\
 	 *                                                                                                   *
@@ -181,18 +276,6 @@ public:
 		};
 	};
 	
-	/* Set register Status */
-	void setStatus(uint8_t value)
-	{
-		write(Status::__address, value, 8);
-	}
-	
-	/* Get register Status */
-	uint8_t getStatus()
-	{
-		return read8(Status::__address, 8);
-	}
-	
 	
 	/****************************************************************************************************\
 	 *                                                                                                  *
@@ -275,18 +358,6 @@ public:
 		};
 	};
 	
-	/* Set register Configuration */
-	void setConfiguration(uint8_t value)
-	{
-		write(Configuration::__address, value, 8);
-	}
-	
-	/* Get register Configuration */
-	uint8_t getConfiguration()
-	{
-		return read8(Configuration::__address, 8);
-	}
-	
 	
 	/****************************************************************************************************\
 	 *                                                                                                  *
@@ -318,18 +389,6 @@ public:
 		};
 	};
 	
-	/* Set register THIGH */
-	void setTHIGH(uint16_t value)
-	{
-		write(THIGH::__address, value, 16);
-	}
-	
-	/* Get register THIGH */
-	uint16_t getTHIGH()
-	{
-		return read16(THIGH::__address, 16);
-	}
-	
 	
 	/*****************************************************************************************************\
 	 *                                                                                                   *
@@ -361,18 +420,6 @@ public:
 		};
 	};
 	
-	/* Set register TLOW */
-	void setTLOW(uint16_t value)
-	{
-		write(TLOW::__address, value, 16);
-	}
-	
-	/* Get register TLOW */
-	uint16_t getTLOW()
-	{
-		return read16(TLOW::__address, 16);
-	}
-	
 	
 	/****************************************************************************************************\
 	 *                                                                                                  *
@@ -404,18 +451,6 @@ public:
 		};
 	};
 	
-	/* Set register TCRIT */
-	void setTCRIT(uint16_t value)
-	{
-		write(TCRIT::__address, value, 16);
-	}
-	
-	/* Get register TCRIT */
-	uint16_t getTCRIT()
-	{
-		return read16(TCRIT::__address, 16);
-	}
-	
 	
 	/****************************************************************************************************\
 	 *                                                                                                  *
@@ -456,18 +491,6 @@ public:
 		};
 	};
 	
-	/* Set register THYST */
-	void setTHYST(uint8_t value)
-	{
-		write(THYST::__address, value, 8);
-	}
-	
-	/* Get register THYST */
-	uint8_t getTHYST()
-	{
-		return read8(THYST::__address, 8);
-	}
-	
 	
 	/*****************************************************************************************************\
 	 *                                                                                                   *
@@ -496,18 +519,6 @@ public:
 		};
 	};
 	
-	/* Set register ID */
-	void setID(uint8_t value)
-	{
-		write(ID::__address, value, 8);
-	}
-	
-	/* Get register ID */
-	uint8_t getID()
-	{
-		return read8(ID::__address, 8);
-	}
-	
 	
 	/****************************************************************************************************\
 	 *                                                                                                  *
@@ -534,16 +545,308 @@ public:
 		};
 	};
 	
+	
+	/****************************************************************************************************\
+	 *                                                                                                  *
+	 *                                             SNAPSHOT                                             *
+	 *                                                                                                  *
+	\****************************************************************************************************/
+	
+	/*
+	 * SNAPSHOT:
+	 * TEMPERATURE (0x00-0x01), Status (0x02) and Configuration (0x03) are contiguous,
+	 * so a complete sample including the flags and the resolution it was taken with
+	 * is read in a single block read.
+	 */
+	struct Snapshot
+	{
+		uint16_t temperature;
+		uint8_t status;
+		uint8_t configuration;
+	};
+};
+
+/*
+ * ADT7410 register API resolved at compile time.
+ * Derive the transport from ADT7410_Device<Transport> and implement
+ *   uint8_t read8(uint16_t address, uint16_t n);
+ *   void write(uint16_t address, uint8_t value, uint16_t n);
+ *   uint16_t read16(uint16_t address, uint16_t n);
+ *   void write(uint16_t address, uint16_t value, uint16_t n);
+ * and optionally readBlock() and error(). The register accessors call the
+ * transport directly, so it can be inlined into them.
+ */
+template<class Transport>
+class ADT7410_Device : public ADT7410_Registers
+{
+public:
+	/* Error of the last transaction, 0 if none. Hide in the transport if it reports errors. */
+	int error()
+	{
+		return 0;
+	}
+	
+	/*
+	 * Block read of length bytes starting at address, relying on the address pointer
+	 * auto-increment of the ADT7410. Bytes are stored in bus order (MSB first).
+	 * Hide in the transport if it can do this in one transaction;
+	 * the default falls back to read16/read8 per register. It stops at the first
+	 * failed transaction, so error() still reports that failure afterwards, and
+	 * zeroes the buffer then.
+	 */
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+	{
+		uint16_t i = 0;
+		while (i < length)
+		{
+			uint16_t a = address + i;
+			if (length - i >= 2 && (a == 0 || a == 4 || a == 6 || a == 8))
+			{
+				uint16_t value = transport().read16(a, 16);
+				buffer[i++] = uint8_t(value >> 8);
+				buffer[i++] = uint8_t(value);
+			}
+			else
+				buffer[i++] = transport().read8(a, 8);
+			if (transport().error())
+			{
+				for (i = 0; i < length; i++)
+					buffer[i] = 0;
+				return;
+			}
+		}
+	}
+	
+	/*
+	 * Error-reporting variants of the transport calls: the value only goes to the
+	 * output argument if the transaction succeeded; the return is error() after
+	 * the transaction, 0 on success.
+	 */
+	int tryRead8(uint16_t address, uint8_t &value)
+	{
+		uint8_t result = transport().read8(address, 8);
+		int e = transport().error();
+		if (!e)
+			value = result;
+		return e;
+	}
+	
+	int tryRead16(uint16_t address, uint16_t &value)
+	{
+		uint16_t result = transport().read16(address, 16);
+		int e = transport().error();
+		if (!e)
+			value = result;
+		return e;
+	}
+	
+	int tryWrite8(uint16_t address, uint8_t value)
+	{
+		transport().write(address, value, 8);
+		return transport().error();
+	}
+	
+	int tryWrite16(uint16_t address, uint16_t value)
+	{
+		transport().write(address, value, 16);
+		return transport().error();
+	}
+	
+	int tryReadBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+	{
+		transport().readBlock(address, buffer, length);
+		return transport().error();
+	}
+	
+	int tryReadSnapshot(Snapshot &snapshot)
+	{
+		Snapshot result = readSnapshot();
+		int e = transport().error();
+		if (!e)
+			snapshot = result;
+		return e;
+	}
+	
+	int trySetRESET()
+	{
+		setRESET();
+		return transport().error();
+	}
+	
+	/* Apply a multi-field update to register Configuration in one write */
+	void modifyConfiguration(const Modify &m)
+	{
+		setConfiguration(uint8_t(m.apply(getConfiguration())));
+	}
+	
+	/* Apply a multi-field update to register THYST in one write */
+	void modifyTHYST(const Modify &m)
+	{
+		setTHYST(uint8_t(m.apply(getTHYST())));
+	}
+	
+	/* Set register TEMPERATURE */
+	void setTEMPERATURE(uint16_t value)
+	{
+		transport().write(TEMPERATURE::__address, value, 16);
+	}
+	
+	/* Get register TEMPERATURE */
+	uint16_t getTEMPERATURE()
+	{
+		return transport().read16(TEMPERATURE::__address, 16);
+	}
+	
+	/* Set register Status */
+	void setStatus(uint8_t value)
+	{
+		transport().write(Status::__address, value, 8);
+	}
+	
+	/* Get register Status */
+	uint8_t getStatus()
+	{
+		return transport().read8(Status::__address, 8);
+	}
+	
+	/* Set register Configuration */
+	void setConfiguration(uint8_t value)
+	{
+		transport().write(Configuration::__address, value, 8);
+	}
+	
+	/* Get register Configuration */
+	uint8_t getConfiguration()
+	{
+		return transport().read8(Configuration::__address, 8);
+	}
+	
+	/* Set register THIGH */
+	void setTHIGH(uint16_t value)
+	{
+		transport().write(THIGH::__address, value, 16);
+	}
+	
+	/* Get register THIGH */
+	uint16_t getTHIGH()
+	{
+		return transport().read16(THIGH::__address, 16);
+	}
+	
+	/* Set register TLOW */
+	void setTLOW(uint16_t value)
+	{
+		transport().write(TLOW::__address, value, 16);
+	}
+	
+	/* Get register TLOW */
+	uint16_t getTLOW()
+	{
+		return transport().read16(TLOW::__address, 16);
+	}
+	
+	/* Set register TCRIT */
+	void setTCRIT(uint16_t value)
+	{
+		transport().write(TCRIT::__address, value, 16);
+	}
+	
+	/* Get register TCRIT */
+	uint16_t getTCRIT()
+	{
+		return transport().read16(TCRIT::__address, 16);
+	}
+	
+	/* Set register THYST */
+	void setTHYST(uint8_t value)
+	{
+		transport().write(THYST::__address, value, 8);
+	}
+	
+	/* Get register THYST */
+	uint8_t getTHYST()
+	{
+		return transport().read8(THYST::__address, 8);
+	}
+	
+	/* Set register ID */
+	void setID(uint8_t value)
+	{
+		transport().write(ID::__address, value, 8);
+	}
+	
+	/* Get register ID */
+	uint8_t getID()
+	{
+		return transport().read8(ID::__address, 8);
+	}
+	
 	/* Set register RESET */
 	void setRESET()
 	{
-		write(RESET::__address, uint8_t(0), 0);
+		transport().write(RESET::__address, uint8_t(0), 0);
 	}
 	
 	/* Get register RESET */
 	uint8_t getRESET()
 	{
-		return read8(RESET::__address, 0);
+		return transport().read8(RESET::__address, 0);
 	}
 	
+	/* Get registers TEMPERATURE, Status and Configuration */
+	Snapshot readSnapshot()
+	{
+		uint8_t buffer[4];
+		transport().readBlock(TEMPERATURE::__address, buffer, 4);
+		Snapshot snapshot;
+		snapshot.temperature = uint16_t((buffer[0] << 8) | buffer[1]);
+		snapshot.status = buffer[2];
+		snapshot.configuration = buffer[3];
+		return snapshot;
+	}
+	
+protected:
+	Transport &transport()
+	{
+		return *static_cast<Transport *>(this);
+	}
 };
+
+/* Derive from class ADT7410_Base and implement the read and write functions! */
+/* (or from ADT7410_Device<Transport> to have them resolved at compile time) */
+
+/* ADT7410: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor */
+/* ADT7410_Device with the transport behind virtual functions */
+class ADT7410_Base : public ADT7410_Device<ADT7410_Base>
+{
+public:
+	/* Pure virtual functions that need to be implemented in derived class: */
+	virtual uint8_t read8(uint16_t address, uint16_t n=8) = 0;  // 8 bit read
+	virtual void write(uint16_t address, uint8_t value, uint16_t n=8) = 0;  // 8 bit write
+	virtual uint16_t read16(uint16_t address, uint16_t n=16) = 0;  // 16 bit read
+	virtual void write(uint16_t address, uint16_t value, uint16_t n=16) = 0;  // 16 bit write
+	
+	virtual ~ADT7410_Base()
+	{
+	}
+	
+	/* Error of the last transaction, 0 if none. Transports without error reporting keep the default. */
+	virtual int error()
+	{
+		return 0;
+	}
+	
+	/*
+	 * Block read of length bytes starting at address, relying on the address pointer
+	 * auto-increment of the ADT7410. Bytes are stored in bus order (MSB first).
+	 * Override in the derived class if the transport can do this in one transaction;
+	 * the default falls back to read16/read8 per register and stops at the first
+	 * failed one, leaving error() on it.
+	 */
+	virtual void readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+	{
+		ADT7410_Device<ADT7410_Base>::readBlock(address, buffer, length);
+	}
+};
+
+#endif /* ADT7410_HPP */
@@ -0,0 +1,221 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Acquisition.cpp
+ */
+
+#include "ADT7410_Acquisition.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <cstring>
+
+ADT7410_Acquisition::ADT7410_Acquisition(ADT7410_SampleSink &sink)
+	: sink(sink), slow_threshold(10000000), max_backoff(64), started(0), running(false)
+{
+}
+
+ADT7410_Acquisition::~ADT7410_Acquisition()
+{
+	stop();
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		pthread_cond_destroy(&buses[i]->wake);
+		pthread_mutex_destroy(&buses[i]->lock);
+		delete buses[i];
+	}
+}
+
+int ADT7410_Acquisition::addBus(uint64_t period)
+{
+	if (running)
+		return -1;
+	Bus *bus = new Bus;
+	bus->owner = this;
+	bus->period = period;
+	memset(&bus->stats, 0, sizeof(bus->stats));
+	bus->stopping = false;
+	pthread_mutex_init(&bus->lock, 0);
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&bus->wake, &attr);
+	pthread_condattr_destroy(&attr);
+	buses.push_back(bus);
+	return int(buses.size() - 1);
+}
+
+uint16_t ADT7410_Acquisition::addDevice(int bus, ADT7410_Base &device)
+{
+	if (running || bus < 0 || bus >= int(buses.size()))
+		return INVALID_DEVICE;
+	Device d;
+	d.device = &device;
+	d.id = uint16_t(devices.size());
+	d.backoff = 0;
+	d.wait = 0;
+	memset(&d.stats, 0, sizeof(d.stats));
+	buses[bus]->devices.push_back(d);
+	devices.push_back(std::make_pair(bus, uint16_t(buses[bus]->devices.size() - 1)));
+	return d.id;
+}
+
+void ADT7410_Acquisition::setSlowThreshold(uint64_t threshold)
+{
+	slow_threshold = threshold;
+}
+
+void ADT7410_Acquisition::setMaxBackoff(uint32_t cycles)
+{
+	max_backoff = cycles;
+}
+
+bool ADT7410_Acquisition::start()
+{
+	if (running)
+		return false;
+	started = ADT7410_now();
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		buses[i]->stopping = false;
+		if (pthread_create(&buses[i]->thread, 0, run, buses[i]) != 0)
+		{
+			for (size_t j = 0; j < i; j++)
+			{
+				pthread_mutex_lock(&buses[j]->lock);
+				buses[j]->stopping = true;
+				pthread_cond_signal(&buses[j]->wake);
+				pthread_mutex_unlock(&buses[j]->lock);
+				pthread_join(buses[j]->thread, 0);
+			}
+			return false;
+		}
+	}
+	running = true;
+	return true;
+}
+
+void ADT7410_Acquisition::stop()
+{
+	if (!running)
+		return;
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		pthread_mutex_lock(&buses[i]->lock);
+		buses[i]->stopping = true;
+		pthread_cond_signal(&buses[i]->wake);
+		pthread_mutex_unlock(&buses[i]->lock);
+	}
+	for (size_t i = 0; i < buses.size(); i++)
+		pthread_join(buses[i]->thread, 0);
+	running = false;
+}
+
+void *ADT7410_Acquisition::run(void *bus)
+{
+	Bus *b = static_cast<Bus *>(bus);
+	b->owner->loop(*b);
+	return 0;
+}
+
+void ADT7410_Acquisition::loop(Bus &bus)
+{
+	uint64_t deadline = ADT7410_now();
+	for (;;)
+	{
+		for (size_t i = 0; i < bus.devices.size(); i++)
+			poll(bus.devices[i]);
+
+		uint64_t now = ADT7410_now();
+		pthread_mutex_lock(&bus.lock);
+		bus.stats.cycles++;
+		deadline += bus.period;
+		if (now > deadline)
+		{
+			/* Do not try to catch up, resynchronise on the current time */
+			if (bus.period)
+				bus.stats.overruns++;
+			deadline = now;
+		}
+		struct timespec ts;
+		ts.tv_sec = time_t(deadline / 1000000000u);
+		ts.tv_nsec = long(deadline % 1000000000u);
+		while (!bus.stopping && bus.period && pthread_cond_timedwait(&bus.wake, &bus.lock, &ts) == 0)
+		{
+		}
+		bool stopping = bus.stopping;
+		pthread_mutex_unlock(&bus.lock);
+		if (stopping)
+			return;
+	}
+}
+
+void ADT7410_Acquisition::poll(Device &device)
+{
+	Bus &bus = *buses[devices[device.id].first];
+	if (device.wait)
+	{
+		device.wait--;
+		pthread_mutex_lock(&bus.lock);
+		device.stats.skipped++;
+		pthread_mutex_unlock(&bus.lock);
+		return;
+	}
+
+	uint64_t begin = ADT7410_now();
+	ADT7410_Base::Snapshot snapshot = device.device->readSnapshot();
+	uint64_t end = ADT7410_now();
+	bool failed = device.device->error() != 0;
+	bool slow = end - begin > slow_threshold;
+
+	if (failed || slow)
+	{
+		device.backoff = device.backoff ? device.backoff * 2 : 1;
+		if (device.backoff > max_backoff)
+			device.backoff = max_backoff;
+		device.wait = device.backoff;
+	}
+	else
+		device.backoff = 0;
+
+	if (!failed)
+		sink.sample(device.id, snapshot, end);
+
+	pthread_mutex_lock(&bus.lock);
+	if (failed)
+		device.stats.errors++;
+	else
+	{
+		device.stats.samples++;
+		bus.stats.samples++;
+	}
+	if (slow)
+		device.stats.slow++;
+	pthread_mutex_unlock(&bus.lock);
+}
+
+ADT7410_Acquisition::BusStats ADT7410_Acquisition::getBusStats(int bus)
+{
+	Bus &b = *buses[bus];
+	pthread_mutex_lock(&b.lock);
+	BusStats stats = b.stats;
+	pthread_mutex_unlock(&b.lock);
+	double elapsed = started ? double(ADT7410_now() - started) * 1e-9 : 0;
+	stats.rate = elapsed > 0 ? double(stats.samples) / elapsed : 0;
+	return stats;
+}
+
+ADT7410_Acquisition::DeviceStats ADT7410_Acquisition::getDeviceStats(uint16_t device)
+{
+	Bus &b = *buses[devices[device].first];
+	pthread_mutex_lock(&b.lock);
+	DeviceStats stats = b.devices[devices[device].second].stats;
+	pthread_mutex_unlock(&b.lock);
+	double elapsed = started ? double(ADT7410_now() - started) * 1e-9 : 0;
+	stats.rate = elapsed > 0 ? double(stats.samples) / elapsed : 0;
+	return stats;
+}
@@ -0,0 +1,139 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Acquisition.hpp
+ */
+
+#ifndef ADT7410_ACQUISITION_HPP
+#define ADT7410_ACQUISITION_HPP
+
+#include "ADT7410.hpp"
+
+#include <vector>
+#include <pthread.h>
+
+/* Receives the samples of an acquisition. Called on the worker thread of the device's bus. */
+class ADT7410_SampleSink
+{
+public:
+	virtual ~ADT7410_SampleSink()
+	{
+	}
+
+	virtual void sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp) = 0;
+};
+
+/*
+ * Acquisition engine for many ADT7410s on several I2C buses.
+ * Every bus gets its own worker thread, so buses are sampled in parallel,
+ * while the devices of one bus are read back-to-back with one snapshot block
+ * read each. A device whose transaction fails or takes longer than the slow
+ * threshold is backed off (skipped for exponentially more cycles) so it cannot
+ * stall its bus-mates.
+ */
+class ADT7410_Acquisition
+{
+public:
+	struct DeviceStats
+	{
+		uint64_t samples;
+		uint64_t errors;   // transactions reporting an error()
+		uint64_t slow;     // transactions exceeding the slow threshold
+		uint64_t skipped;  // cycles skipped while backed off
+		double rate;       // samples per second since start()
+	};
+
+	struct BusStats
+	{
+		uint64_t cycles;
+		uint64_t samples;
+		uint64_t overruns;  // cycles that took longer than the period
+		double rate;        // samples per second since start()
+	};
+
+	ADT7410_Acquisition(ADT7410_SampleSink &sink);
+	~ADT7410_Acquisition();
+
+	/* Add a bus sampled every period nanoseconds (0: as fast as possible), returns the bus index */
+	int addBus(uint64_t period);
+
+	/* Returned by addDevice() on failure */
+	enum { INVALID_DEVICE = 0xFFFF };
+
+	/* Add a device to a bus, returns the device id passed to the sink */
+	uint16_t addDevice(int bus, ADT7410_Base &device);
+
+	/* Transactions slower than this (nanoseconds) back the device off, default 10 ms */
+	void setSlowThreshold(uint64_t threshold);
+
+	/* Longest back-off in cycles, default 64 */
+	void setMaxBackoff(uint32_t cycles);
+
+	/* Start one worker thread per bus, buses and devices cannot be added while running */
+	bool start();
+
+	/* Stop and join all workers */
+	void stop();
+
+	bool isRunning() const
+	{
+		return running;
+	}
+
+	int getBusCount() const
+	{
+		return int(buses.size());
+	}
+
+	uint16_t getDeviceCount() const
+	{
+		return uint16_t(devices.size());
+	}
+
+	BusStats getBusStats(int bus);
+	DeviceStats getDeviceStats(uint16_t device);
+
+private:
+	ADT7410_Acquisition(const ADT7410_Acquisition &);
+	ADT7410_Acquisition &operator=(const ADT7410_Acquisition &);
+
+	struct Device
+	{
+		ADT7410_Base *device;
+		uint16_t id;
+		uint32_t backoff;  // current back-off in cycles
+		uint32_t wait;     // cycles left to skip
+		DeviceStats stats;
+	};
+
+	struct Bus
+	{
+		ADT7410_Acquisition *owner;
+		uint64_t period;
+		std::vector<Device> devices;
+		BusStats stats;
+		pthread_t thread;
+		pthread_mutex_t lock;  // protects stats (bus and devices) and stopping
+		pthread_cond_t wake;
+		bool stopping;
+	};
+
+	static void *run(void *bus);
+	void loop(Bus &bus);
+	void poll(Device &device);
+
+	ADT7410_SampleSink &sink;
+	std::vector<Bus *> buses;
+	std::vector<std::pair<int, uint16_t> > devices;  // id -> bus, index on bus
+	uint64_t slow_threshold;
+	uint32_t max_backoff;
+	uint64_t started;
+	bool running;
+};
+
+#endif /* ADT7410_ACQUISITION_HPP */
@@ -0,0 +1,125 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Alarm.cpp
+ */
+
+#include "ADT7410_Alarm.hpp"
+#include "ADT7410_Decode.hpp"
+
+typedef ADT7410_Base::Configuration C;
+
+ADT7410_AlarmTable::ADT7410_AlarmTable(size_t devices)
+{
+	resize(devices);
+}
+
+void ADT7410_AlarmTable::resize(size_t devices)
+{
+	size_t old = size();
+	configuration.resize(devices);
+	tlow.resize(devices);
+	thigh.resize(devices);
+	tcrit.resize(devices);
+	hysteresis.resize(devices);
+	queue.resize(devices);
+	comparator.resize(devices);
+	active.resize(devices);
+	flags.resize(devices);
+	interrupt.resize(devices);
+	faults_low.resize(devices);
+	faults_high.resize(devices);
+	faults_crit.resize(devices);
+
+	/* New devices start with the power-on setpoints */
+	for (size_t i = old; i < devices; i++)
+		configure(i, 0, ADT7410_Base::THIGH::THIGH_::dflt, ADT7410_Base::TLOW::TLOW_::dflt,
+			ADT7410_Base::TCRIT::TCRIT_::dflt, ADT7410_Base::THYST::HYSTERESIS::dflt);
+}
+
+void ADT7410_AlarmTable::configure(size_t device, uint8_t configuration, uint16_t thigh, uint16_t tlow, uint16_t tcrit, uint8_t thyst)
+{
+	this->configuration[device] = configuration;
+	this->tlow[device] = int16_t(tlow);
+	this->thigh[device] = int16_t(thigh);
+	this->tcrit[device] = int16_t(tcrit);
+	hysteresis[device] = int16_t(ADT7410_Base::get<ADT7410_Base::THYST::HYSTERESIS>(thyst) * 128);
+	queue[device] = uint8_t(ADT7410_Base::get<C::FAULT_QUEUE>(configuration) + 1);
+	comparator[device] = ADT7410_Base::get<C::INT_CT_MODE>(configuration) == C::INT_CT_MODE::COMPARATOR_MODE;
+	clear(device);
+}
+
+void ADT7410_AlarmTable::clear(size_t device)
+{
+	active[device] = 0;
+	flags[device] = 0;
+	interrupt[device] = 0;
+	faults_low[device] = 0;
+	faults_high[device] = 0;
+	faults_crit[device] = 0;
+}
+
+bool ADT7410_AlarmTable::evaluate(size_t device, int16_t t)
+{
+	uint8_t before = active[device];
+	bool irq = interrupt[device] != 0;
+	ADT7410_AlarmLogic::evaluate(t, tlow[device], thigh[device], tcrit[device], hysteresis[device],
+		queue[device], comparator[device] != 0, active[device], flags[device], irq,
+		faults_low[device], faults_high[device], faults_crit[device]);
+	interrupt[device] = irq;
+	return active[device] != before;
+}
+
+size_t ADT7410_AlarmTable::update(const ADT7410_Sample *samples, size_t n)
+{
+	size_t transitions = 0;
+	const size_t devices = size();
+	for (size_t i = 0; i < n; i++)
+	{
+		const ADT7410_Sample &s = samples[i];
+		if (s.device >= devices)
+			continue;
+		bool res16 = ADT7410_Base::get<C::RESOLUTION>(s.configuration) == C::RESOLUTION::RES_16_BIT;
+		transitions += evaluate(s.device, ADT7410_decode(s.temperature, res16));
+	}
+	return transitions;
+}
+
+size_t ADT7410_AlarmTable::update(const uint16_t *raw, size_t n, bool res16, size_t first)
+{
+	size_t transitions = 0;
+	if (first >= size())
+		return 0;
+	if (n > size() - first)
+		n = size() - first;
+	const uint16_t mask = ADT7410_temperatureMask(res16);
+	for (size_t i = 0; i < n; i++)
+		transitions += evaluate(first + i, int16_t(raw[i] & mask));
+	return transitions;
+}
+
+uint8_t ADT7410_AlarmTable::readStatus(size_t device)
+{
+	uint8_t status = flags[device];
+	flags[device] = 0;
+	interrupt[device] = 0;
+	return status;
+}
+
+bool ADT7410_AlarmTable::getINT(size_t device) const
+{
+	bool level = comparator[device] ? (active[device] & (ADT7410_AlarmLogic::TLOW | ADT7410_AlarmLogic::THIGH)) != 0
+		: interrupt[device] != 0;
+	return ADT7410_Base::get<C::INT_PIN_POLARITY>(configuration[device]) == C::INT_PIN_POLARITY::ACTIVE_HIGH ? level : !level;
+}
+
+bool ADT7410_AlarmTable::getCT(size_t device) const
+{
+	bool level = (active[device] & ADT7410_AlarmLogic::TCRIT) != 0;
+	return ADT7410_Base::get<C::CT_PIN_POLARITY>(configuration[device]) == C::CT_PIN_POLARITY::ACTIVE_HIGH ? level : !level;
+}
@@ -0,0 +1,177 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Alarm.hpp
+ */
+
+#ifndef ADT7410_ALARM_HPP
+#define ADT7410_ALARM_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Ring.hpp"
+
+#include <vector>
+
+/*
+ * The TLOW/THIGH/TCRIT logic of the ADT7410, applied once per conversion result.
+ *
+ * An alarm becomes active after FAULT_QUEUE + 1 consecutive results beyond its
+ * limit (below TLOW, above THIGH, above TCRIT) and inactive again once a result
+ * is back within the limit including THYST (above TLOW + THYST, below THIGH - THYST
+ * or TCRIT - THYST). In comparator mode the Status flags follow the active state;
+ * in interrupt mode they are set on activation, cleared by a Status read, and INT
+ * is asserted both on activation and on return of TLOW and THIGH. CT always
+ * follows the active TCRIT state.
+ *
+ * Alarm bits are kept in Status register positions, so a flags byte ORs straight
+ * into a Status value.
+ */
+struct ADT7410_AlarmLogic
+{
+	/*
+	 * The generated names of Status bits 4 and 5 are swapped with respect to their
+	 * descriptions; the descriptions follow the datasheet: bit 4 flags TLOW, bit 5 THIGH.
+	 */
+	enum
+	{
+		TLOW = ADT7410_Base::Status::THIGH::mask,
+		THIGH = ADT7410_Base::Status::TLOW::mask,
+		TCRIT = ADT7410_Base::Status::TCRIT::mask,
+		ALL = TLOW | THIGH | TCRIT
+	};
+
+	/* Advance one alarm by one result */
+	static void step(uint8_t alarm, bool beyond, bool within, uint8_t queue, bool comparator,
+		uint8_t &active, uint8_t &flags, bool &interrupt, uint8_t &faults)
+	{
+		if (beyond)
+		{
+			if (faults < 255)
+				faults++;
+		}
+		else
+			faults = 0;
+
+		if (!(active & alarm) && beyond && faults >= queue)
+		{
+			active |= alarm;
+			flags |= alarm;
+			if (alarm != TCRIT)
+				interrupt = true;
+		}
+		else if ((active & alarm) && within)
+		{
+			active &= uint8_t(~alarm);
+			if (comparator)
+				flags &= uint8_t(~alarm);
+			else if (alarm != TCRIT)
+				interrupt = true;
+		}
+		else if (comparator && (active & alarm))
+			flags |= alarm;
+	}
+
+	/*
+	 * Advance all three alarms by the converted temperature t (1/128 °C, flag bits cleared).
+	 * queue is FAULT_QUEUE + 1, hysteresis THYST in 1/128 °C.
+	 */
+	static void evaluate(int16_t t, int16_t tlow, int16_t thigh, int16_t tcrit, int32_t hysteresis,
+		uint8_t queue, bool comparator, uint8_t &active, uint8_t &flags, bool &interrupt,
+		uint8_t &faults_low, uint8_t &faults_high, uint8_t &faults_crit)
+	{
+		step(TLOW, t < tlow, t > tlow + hysteresis, queue, comparator, active, flags, interrupt, faults_low);
+		step(THIGH, t > thigh, t < thigh - hysteresis, queue, comparator, active, flags, interrupt, faults_high);
+		step(TCRIT, t > tcrit, t < tcrit - hysteresis, queue, comparator, active, flags, interrupt, faults_crit);
+	}
+
+	/* The flag bits the 13-bit TEMPERATURE word carries in comparator mode */
+	static uint16_t temperatureFlags(uint8_t active)
+	{
+		return uint16_t((active & TLOW ? ADT7410_Base::TEMPERATURE::TLOWFLAG_LSB0::mask : 0)
+			| (active & THIGH ? ADT7410_Base::TEMPERATURE::THIGHFLAG_LSB1::mask : 0)
+			| (active & TCRIT ? ADT7410_Base::TEMPERATURE::TCRITFLAG_LSB2::mask : 0));
+	}
+};
+
+/*
+ * Host-side alarm state of a fleet of devices, evaluated from their samples
+ * instead of polling every Status register.
+ *
+ * Setpoints and state are kept as a structure of arrays indexed by device, so a
+ * pass over a batch of samples touches only a few bytes per device. Fed with
+ * every conversion result of a device, the state equals the device's own; fed
+ * with fewer (e.g. a slower sampling period), FAULT_QUEUE counts samples rather
+ * than conversions.
+ */
+class ADT7410_AlarmTable
+{
+public:
+	ADT7410_AlarmTable(size_t devices = 0);
+
+	/* Number of devices; resizing keeps the state of the devices below the new size */
+	size_t size() const
+	{
+		return configuration.size();
+	}
+
+	void resize(size_t devices);
+
+	/* Set the setpoints of a device from its register values, resets its alarm state */
+	void configure(size_t device, uint8_t configuration, uint16_t thigh, uint16_t tlow, uint16_t tcrit, uint8_t thyst);
+
+	/* Forget the alarm state of a device, as after power-on or RESET */
+	void clear(size_t device);
+
+	/* Evaluate a batch of samples, sample.device is the table index; returns the number of alarm transitions */
+	size_t update(const ADT7410_Sample *samples, size_t n);
+
+	/* Evaluate one raw TEMPERATURE word per device, raw[i] for device first + i */
+	size_t update(const uint16_t *raw, size_t n, bool res16, size_t first = 0);
+
+	/* Alarm flags as the Status register would show them */
+	uint8_t getStatus(size_t device) const
+	{
+		return flags[device];
+	}
+
+	/* Status as a read would return it, clearing the flags and INT like the device does */
+	uint8_t readStatus(size_t device);
+
+	/* Active (comparator) state of the alarms, in Status bit positions */
+	uint8_t getActive(size_t device) const
+	{
+		return active[device];
+	}
+
+	/* INT and CT pin levels, taking the configured polarities into account */
+	bool getINT(size_t device) const;
+	bool getCT(size_t device) const;
+
+private:
+	/* Evaluate one result, returns true if the active state changed */
+	bool evaluate(size_t device, int16_t t);
+
+	/* Setpoints */
+	std::vector<uint8_t> configuration;
+	std::vector<int16_t> tlow;
+	std::vector<int16_t> thigh;
+	std::vector<int16_t> tcrit;
+	std::vector<int16_t> hysteresis;  // 1/128 °C
+	std::vector<uint8_t> queue;       // FAULT_QUEUE + 1
+	std::vector<uint8_t> comparator;
+
+	/* State */
+	std::vector<uint8_t> active;
+	std::vector<uint8_t> flags;
+	std::vector<uint8_t> interrupt;
+	std::vector<uint8_t> faults_low;
+	std::vector<uint8_t> faults_high;
+	std::vector<uint8_t> faults_crit;
+};
+
+#endif /* ADT7410_ALARM_HPP */
@@ -0,0 +1,465 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Async.cpp
+ */
+
+#include "ADT7410_Async.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/* Registers are 12 bytes, 0 to 11; a block read never runs past ID */
+static const uint16_t REGISTER_END = ADT7410_Base::ID::__address + 1;
+
+ADT7410_AsyncBus::ADT7410_AsyncBus(Delivery delivery)
+	: delivery(delivery), event_fd(-1), in_loop(false), next_id(1), running(false), stopping(false)
+{
+	if (delivery == EVENTFD)
+		event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	pthread_mutex_init(&lock, 0);
+	pthread_cond_init(&wake, 0);
+	memset(&stats, 0, sizeof(stats));
+}
+
+ADT7410_AsyncBus::~ADT7410_AsyncBus()
+{
+	stop();
+	pthread_cond_destroy(&wake);
+	pthread_mutex_destroy(&lock);
+	if (event_fd >= 0)
+		close(event_fd);
+}
+
+uint16_t ADT7410_AsyncBus::width(uint16_t address)
+{
+	switch (address)
+	{
+	case ADT7410_Base::TEMPERATURE::__address:
+	case ADT7410_Base::THIGH::__address:
+	case ADT7410_Base::TLOW::__address:
+	case ADT7410_Base::TCRIT::__address:
+		return 16;
+	case ADT7410_Base::RESET::__address:
+		return 0;
+	default:
+		return 8;
+	}
+}
+
+bool ADT7410_AsyncBus::start()
+{
+	if (running || (delivery == EVENTFD && event_fd < 0))
+		return false;
+	stopping = false;
+	if (pthread_create(&thread, 0, run, this) != 0)
+		return false;
+	running = true;
+	return true;
+}
+
+void ADT7410_AsyncBus::stop()
+{
+	if (!running)
+		return;
+	pthread_mutex_lock(&lock);
+	stopping = true;
+	pthread_cond_signal(&wake);
+	pthread_mutex_unlock(&lock);
+	pthread_join(thread, 0);
+	running = false;
+}
+
+uint32_t ADT7410_AsyncBus::submitRead(ADT7410_Base &device, uint16_t address, ADT7410_AsyncCallback *callback, void *context)
+{
+	Request r;
+	r.result.device = &device;
+	r.result.address = address;
+	r.result.write = false;
+	r.result.value = 0;
+	r.result.error = 0;
+	r.result.context = context;
+	r.callback = callback;
+	r.direct = false;
+	return submit(&r, 1);
+}
+
+uint32_t ADT7410_AsyncBus::submitWrite(ADT7410_Base &device, uint16_t address, uint16_t value, ADT7410_AsyncCallback *callback, void *context)
+{
+	Request r;
+	r.result.device = &device;
+	r.result.address = address;
+	r.result.write = true;
+	r.result.value = value;
+	r.result.error = 0;
+	r.result.context = context;
+	r.callback = callback;
+	r.direct = false;
+	return submit(&r, 1);
+}
+
+uint32_t ADT7410_AsyncBus::submit(const Request *requests, size_t count)
+{
+	pthread_mutex_lock(&lock);
+	if (!running || stopping || !count)
+	{
+		pthread_mutex_unlock(&lock);
+		return 0;
+	}
+	uint32_t first = next_id;
+	for (size_t i = 0; i < count; i++)
+	{
+		queue.push_back(requests[i]);
+		queue.back().result.id = next_id++;
+		if (!next_id)
+			next_id = 1;
+	}
+	stats.submitted += count;
+	pthread_cond_signal(&wake);
+	pthread_mutex_unlock(&lock);
+	return first;
+}
+
+bool ADT7410_AsyncBus::isWorker()
+{
+	pthread_mutex_lock(&lock);
+	bool worker_thread = in_loop && pthread_equal(worker, pthread_self());
+	pthread_mutex_unlock(&lock);
+	return worker_thread;
+}
+
+size_t ADT7410_AsyncBus::dispatch()
+{
+	if (event_fd < 0)
+		return 0;
+	uint64_t count;
+	if (read(event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+		return 0;
+
+	std::vector<Request> done;
+	pthread_mutex_lock(&lock);
+	done.swap(completions);
+	pthread_mutex_unlock(&lock);
+
+	for (size_t i = 0; i < done.size(); i++)
+		if (done[i].callback)
+			done[i].callback->complete(done[i].result);
+	return done.size();
+}
+
+ADT7410_AsyncBus::Stats ADT7410_AsyncBus::getStats()
+{
+	pthread_mutex_lock(&lock);
+	Stats copy = stats;
+	pthread_mutex_unlock(&lock);
+	return copy;
+}
+
+void *ADT7410_AsyncBus::run(void *bus)
+{
+	static_cast<ADT7410_AsyncBus *>(bus)->loop();
+	return 0;
+}
+
+void ADT7410_AsyncBus::loop()
+{
+	std::vector<Request> batch;
+	pthread_mutex_lock(&lock);
+	worker = pthread_self();
+	in_loop = true;
+	for (;;)
+	{
+		while (queue.empty() && !stopping)
+			pthread_cond_wait(&wake, &lock);
+		if (queue.empty())
+			break;
+
+		/* Take everything queued, requests submitted meanwhile form the next batch */
+		batch.assign(queue.begin(), queue.end());
+		queue.clear();
+		pthread_mutex_unlock(&lock);
+
+		execute(batch);
+		complete(batch);
+
+		pthread_mutex_lock(&lock);
+	}
+	in_loop = false;
+	pthread_mutex_unlock(&lock);
+}
+
+void ADT7410_AsyncBus::execute(std::vector<Request> &batch)
+{
+	uint64_t transactions = 0;
+	size_t i = 0;
+	while (i < batch.size())
+	{
+		ADT7410_AsyncResult &r = batch[i].result;
+		ADT7410_Base &device = *r.device;
+		uint16_t bits = width(r.address);
+		transactions++;
+
+		if (r.write)
+		{
+			if (bits == 16)
+				device.write(r.address, r.value, 16);
+			else
+				device.write(r.address, uint8_t(r.value), bits);
+			r.error = device.error();
+			i++;
+			continue;
+		}
+
+		/* Extend over the following reads of this device while they stay contiguous */
+		uint16_t begin = r.address, end = uint16_t(r.address + bits / 8);
+		size_t j = i + 1;
+		if (bits && end <= REGISTER_END)
+			for (; j < batch.size(); j++)
+			{
+				const ADT7410_AsyncResult &next = batch[j].result;
+				uint16_t next_end = uint16_t(next.address + width(next.address) / 8);
+				if (next.write || next.device != r.device || next_end == next.address
+					|| next.address < begin || next.address > end || next_end > REGISTER_END)
+					break;
+				if (next_end > end)
+					end = next_end;
+			}
+
+		if (j == i + 1)
+		{
+			r.value = bits == 16 ? device.read16(r.address, 16) : device.read8(r.address, bits);
+			r.error = device.error();
+			i++;
+			continue;
+		}
+
+		uint8_t buffer[REGISTER_END];
+		device.readBlock(begin, buffer, uint16_t(end - begin));
+		int error = device.error();
+		for (; i < j; i++)
+		{
+			ADT7410_AsyncResult &c = batch[i].result;
+			const uint8_t *p = buffer + (c.address - begin);
+			c.value = width(c.address) == 16 ? uint16_t((p[0] << 8) | p[1]) : p[0];
+			c.error = error;
+		}
+	}
+
+	pthread_mutex_lock(&lock);
+	stats.transactions += transactions;
+	stats.coalesced += batch.size() - transactions;
+	pthread_mutex_unlock(&lock);
+}
+
+void ADT7410_AsyncBus::complete(std::vector<Request> &done)
+{
+	bool signal = false;
+	for (size_t i = 0; i < done.size(); i++)
+	{
+		if (delivery == CALLBACK || done[i].direct)
+		{
+			if (done[i].callback)
+				done[i].callback->complete(done[i].result);
+			continue;
+		}
+		pthread_mutex_lock(&lock);
+		completions.push_back(done[i]);
+		pthread_mutex_unlock(&lock);
+		signal = true;
+	}
+
+	pthread_mutex_lock(&lock);
+	stats.completed += done.size();
+	pthread_mutex_unlock(&lock);
+
+	if (signal)
+	{
+		uint64_t one = 1;
+		ssize_t written = ::write(event_fd, &one, sizeof(one));
+		(void)written;
+	}
+}
+
+
+/* Completion target of a blocking call: stores the values and counts the outstanding requests down */
+class ADT7410_AsyncDevice::Waiter : public ADT7410_AsyncCallback
+{
+public:
+	Waiter()
+		: pending(0), error(0)
+	{
+		pthread_mutex_init(&lock, 0);
+		pthread_cond_init(&done, 0);
+	}
+
+	~Waiter()
+	{
+		pthread_cond_destroy(&done);
+		pthread_mutex_destroy(&lock);
+	}
+
+	/* Add a direct request, result points to where the value goes */
+	void add(ADT7410_Base &device, uint16_t address, bool write, uint16_t value, uint16_t *result)
+	{
+		ADT7410_AsyncBus::Request r;
+		r.result.device = &device;
+		r.result.address = address;
+		r.result.write = write;
+		r.result.value = value;
+		r.result.error = 0;
+		r.result.context = result;
+		r.callback = this;
+		r.direct = true;
+		requests.push_back(r);
+	}
+
+	/* Queue the added requests together, so no other request gets between them */
+	bool submit(ADT7410_AsyncBus &bus)
+	{
+		if (requests.empty())
+			return true;
+		pthread_mutex_lock(&lock);
+		pending = requests.size();
+		pthread_mutex_unlock(&lock);
+		if (bus.submit(&requests[0], requests.size()))
+			return true;
+		pthread_mutex_lock(&lock);
+		pending = 0;
+		error = ENODEV;
+		pthread_mutex_unlock(&lock);
+		return false;
+	}
+
+	/* Wait for all submitted requests, returns the first error */
+	int wait()
+	{
+		pthread_mutex_lock(&lock);
+		while (pending)
+			pthread_cond_wait(&done, &lock);
+		int result = error;
+		pthread_mutex_unlock(&lock);
+		return result;
+	}
+
+	void complete(const ADT7410_AsyncResult &result)
+	{
+		pthread_mutex_lock(&lock);
+		if (result.context)
+			*static_cast<uint16_t *>(result.context) = result.value;
+		if (result.error && !error)
+			error = result.error;
+		if (!--pending)
+			pthread_cond_signal(&done);
+		pthread_mutex_unlock(&lock);
+	}
+
+private:
+	std::vector<ADT7410_AsyncBus::Request> requests;
+	pthread_mutex_t lock;
+	pthread_cond_t done;
+	size_t pending;
+	int error;
+};
+
+ADT7410_AsyncDevice::ADT7410_AsyncDevice(ADT7410_AsyncBus &bus, ADT7410_Base &device)
+	: bus(bus), device(device), last_error(0)
+{
+}
+
+ADT7410_AsyncDevice::~ADT7410_AsyncDevice()
+{
+}
+
+uint16_t ADT7410_AsyncDevice::transfer(uint16_t address, bool write, uint16_t value)
+{
+	if (bus.isWorker())
+	{
+		last_error = EDEADLK;
+		return 0;
+	}
+	Waiter waiter;
+	uint16_t result = 0;
+	waiter.add(device, address, write, value, &result);
+	waiter.submit(bus);
+	last_error = waiter.wait();
+	return result;
+}
+
+uint8_t ADT7410_AsyncDevice::read8(uint16_t address, uint16_t n)
+{
+	(void)n;
+	return uint8_t(transfer(address, false, 0));
+}
+
+void ADT7410_AsyncDevice::write(uint16_t address, uint8_t value, uint16_t n)
+{
+	(void)n;
+	transfer(address, true, value);
+}
+
+uint16_t ADT7410_AsyncDevice::read16(uint16_t address, uint16_t n)
+{
+	(void)n;
+	return transfer(address, false, 0);
+}
+
+void ADT7410_AsyncDevice::write(uint16_t address, uint16_t value, uint16_t n)
+{
+	(void)n;
+	transfer(address, true, value);
+}
+
+void ADT7410_AsyncDevice::readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+{
+	uint16_t values[REGISTER_END];
+	memset(buffer, 0, length);
+	if (bus.isWorker())
+	{
+		last_error = EDEADLK;
+		return;
+	}
+	if (length > REGISTER_END || address + length > REGISTER_END)
+	{
+		ADT7410_Base::readBlock(address, buffer, length);
+		return;
+	}
+
+	/* One request per register, queued together so they are coalesced */
+	Waiter waiter;
+	uint16_t offsets[REGISTER_END];
+	size_t count = 0;
+	for (uint16_t i = 0; i < length; count++)
+	{
+		uint16_t a = uint16_t(address + i);
+		uint16_t bytes = ADT7410_AsyncBus::width(a) == 16 ? 2 : 1;
+		offsets[count] = i;
+		values[count] = 0;
+		waiter.add(device, a, false, 0, &values[count]);
+		i = uint16_t(i + bytes);
+	}
+	waiter.submit(bus);
+	last_error = waiter.wait();
+	if (last_error)
+		return;
+
+	for (size_t c = 0; c < count; c++)
+	{
+		uint16_t i = offsets[c];
+		if (ADT7410_AsyncBus::width(uint16_t(address + i)) != 16)
+			buffer[i] = uint8_t(values[c]);
+		else
+		{
+			/* A block ending on the MSB of a 16-bit register keeps only that byte */
+			buffer[i] = uint8_t(values[c] >> 8);
+			if (length - i >= 2)
+				buffer[i + 1] = uint8_t(values[c]);
+		}
+	}
+}
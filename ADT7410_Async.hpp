@@ -0,0 +1,182 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Async.hpp
+ */
+
+#ifndef ADT7410_ASYNC_HPP
+#define ADT7410_ASYNC_HPP
+
+#include "ADT7410.hpp"
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+/* Outcome of an asynchronous register transaction */
+struct ADT7410_AsyncResult
+{
+	uint32_t id;            // as returned by submitRead/submitWrite
+	ADT7410_Base *device;
+	uint16_t address;
+	bool write;
+	uint16_t value;         // value read, or value written
+	int error;              // device error() after the transaction, 0 on success
+	void *context;          // as passed on submission
+};
+
+/* Receives completions */
+class ADT7410_AsyncCallback
+{
+public:
+	virtual ~ADT7410_AsyncCallback()
+	{
+	}
+
+	virtual void complete(const ADT7410_AsyncResult &result) = 0;
+};
+
+/*
+ * Non-blocking transaction queue of one I2C bus.
+ * Requests of all devices on the bus are queued and executed back-to-back by
+ * one worker thread. Consecutive reads of the same device that cover adjacent
+ * registers (e.g. TEMPERATURE, Status and Configuration) are coalesced into a
+ * single block read; registers that were not requested are never read, so no
+ * Status flags or nRDY are cleared behind the caller's back.
+ * Completions are delivered either on the worker thread (CALLBACK) or queued
+ * and signalled through an eventfd (EVENTFD) that can sit in an epoll loop,
+ * which then calls dispatch() to run the callbacks on its own thread.
+ * Callbacks may submit further requests, but must not wait for them: see
+ * ADT7410_AsyncDevice.
+ */
+class ADT7410_AsyncBus
+{
+public:
+	enum Delivery
+	{
+		CALLBACK,
+		EVENTFD
+	};
+
+	struct Stats
+	{
+		uint64_t submitted;
+		uint64_t completed;
+		uint64_t transactions;  // bus transactions issued
+		uint64_t coalesced;     // requests served by a block read of another request
+	};
+
+	ADT7410_AsyncBus(Delivery delivery = EVENTFD);
+	~ADT7410_AsyncBus();
+
+	/* Start the worker thread */
+	bool start();
+
+	/* Finish all queued requests and stop the worker */
+	void stop();
+
+	/* Queue a register read, returns the request id (never 0), 0 if not running */
+	uint32_t submitRead(ADT7410_Base &device, uint16_t address, ADT7410_AsyncCallback *callback, void *context = 0);
+
+	/* Queue a register write (a RESET write ignores value), returns the request id, 0 if not running */
+	uint32_t submitWrite(ADT7410_Base &device, uint16_t address, uint16_t value, ADT7410_AsyncCallback *callback, void *context = 0);
+
+	/* Readable when completions are pending (EVENTFD delivery), -1 otherwise */
+	int getEventFd() const
+	{
+		return event_fd;
+	}
+
+	/* Run the callbacks of pending completions (EVENTFD delivery), returns their number */
+	size_t dispatch();
+
+	/* Whether the calling thread is the worker, where CALLBACK completions run */
+	bool isWorker();
+
+	Stats getStats();
+
+	/* Width in bits of the register at address: 16, 8, or 0 for the RESET command */
+	static uint16_t width(uint16_t address);
+
+private:
+	ADT7410_AsyncBus(const ADT7410_AsyncBus &);
+	ADT7410_AsyncBus &operator=(const ADT7410_AsyncBus &);
+
+	friend class ADT7410_AsyncDevice;
+
+	struct Request
+	{
+		ADT7410_AsyncResult result;
+		ADT7410_AsyncCallback *callback;
+		bool direct;  // complete on the worker thread whatever the delivery
+	};
+
+	/* Queue count requests back-to-back under one lock, returns the id of the first, 0 if not running */
+	uint32_t submit(const Request *requests, size_t count);
+	static void *run(void *bus);
+	void loop();
+	void execute(std::vector<Request> &batch);
+	void complete(std::vector<Request> &done);
+
+	Delivery delivery;
+	int event_fd;
+	pthread_t thread;
+	pthread_mutex_t lock;       // protects everything below
+	pthread_t worker;           // the worker thread, valid while in_loop
+	bool in_loop;
+	pthread_cond_t wake;
+	std::deque<Request> queue;
+	std::vector<Request> completions;
+	uint32_t next_id;
+	bool running;
+	bool stopping;
+	Stats stats;
+};
+
+/*
+ * Blocking ADT7410_Base on top of an ADT7410_AsyncBus: every access is
+ * submitted to the bus queue and waited for, so blocking callers share the
+ * bus pipeline with the asynchronous ones.
+ * The worker cannot wait for itself: called on the worker thread (i.e. from a
+ * CALLBACK completion) every access fails at once with error() EDEADLK and
+ * reads return 0. Use submitRead/submitWrite there, or EVENTFD delivery, whose
+ * callbacks run on the thread calling dispatch().
+ */
+class ADT7410_AsyncDevice : public ADT7410_Base
+{
+public:
+	ADT7410_AsyncDevice(ADT7410_AsyncBus &bus, ADT7410_Base &device);
+	~ADT7410_AsyncDevice();
+
+	int error()
+	{
+		return last_error;
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n=8);
+	void write(uint16_t address, uint8_t value, uint16_t n=8);
+	uint16_t read16(uint16_t address, uint16_t n=16);
+	void write(uint16_t address, uint16_t value, uint16_t n=16);
+
+	/* Queues the register reads together, so the bus serves them with one block read */
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length);
+
+private:
+	ADT7410_AsyncDevice(const ADT7410_AsyncDevice &);
+	ADT7410_AsyncDevice &operator=(const ADT7410_AsyncDevice &);
+
+	class Waiter;
+
+	uint16_t transfer(uint16_t address, bool write, uint16_t value);
+
+	ADT7410_AsyncBus &bus;
+	ADT7410_Base &device;
+	int last_error;
+};
+
+#endif /* ADT7410_ASYNC_HPP */
@@ -0,0 +1,121 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Atomic.hpp
+ */
+
+#ifndef ADT7410_ATOMIC_HPP
+#define ADT7410_ATOMIC_HPP
+
+#include <cinttypes>
+
+/*
+ * Minimal 32-bit atomics for C++98 toolchains, mapped onto the compiler's
+ * platform primitives: the __atomic builtins (GCC >= 4.7, Clang), the older
+ * __sync builtins, or the MSVC Interlocked functions.
+ */
+
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+
+inline uint32_t ADT7410_loadAcquire(const volatile uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline void ADT7410_storeRelease(volatile uint32_t *p, uint32_t value)
+{
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+inline bool ADT7410_compareExchange(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+	return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+inline uint32_t ADT7410_fetchAdd(volatile uint32_t *p, uint32_t value)
+{
+	return __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+
+inline void ADT7410_fence()
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#elif defined(__GNUC__)
+
+inline uint32_t ADT7410_loadAcquire(const volatile uint32_t *p)
+{
+	uint32_t value = *p;
+	__sync_synchronize();
+	return value;
+}
+
+inline void ADT7410_storeRelease(volatile uint32_t *p, uint32_t value)
+{
+	__sync_synchronize();
+	*p = value;
+}
+
+inline bool ADT7410_compareExchange(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+	return __sync_bool_compare_and_swap(p, expected, desired);
+}
+
+inline uint32_t ADT7410_fetchAdd(volatile uint32_t *p, uint32_t value)
+{
+	return __sync_fetch_and_add(p, value);
+}
+
+inline void ADT7410_fence()
+{
+	__sync_synchronize();
+}
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+
+inline uint32_t ADT7410_loadAcquire(const volatile uint32_t *p)
+{
+	uint32_t value = *p;
+	_ReadWriteBarrier();
+	return value;
+}
+
+inline void ADT7410_storeRelease(volatile uint32_t *p, uint32_t value)
+{
+	_ReadWriteBarrier();
+	*p = value;
+}
+
+inline bool ADT7410_compareExchange(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+	return uint32_t(_InterlockedCompareExchange(reinterpret_cast<volatile long *>(p), long(desired), long(expected))) == expected;
+}
+
+inline uint32_t ADT7410_fetchAdd(volatile uint32_t *p, uint32_t value)
+{
+	return uint32_t(_InterlockedExchangeAdd(reinterpret_cast<volatile long *>(p), long(value)));
+}
+
+inline void ADT7410_fence()
+{
+	/* Interlocked operations are full barriers */
+	volatile long dummy = 0;
+	_InterlockedExchange(&dummy, 1);
+}
+
+#else
+#error "ADT7410_Atomic.hpp: no atomic primitives known for this compiler"
+#endif
+
+/* Size assumed for padding shared data to separate cache lines */
+#define ADT7410_CACHE_LINE 64
+
+#endif /* ADT7410_ATOMIC_HPP */
@@ -0,0 +1,233 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Controller.cpp
+ */
+
+#include "ADT7410_Controller.hpp"
+#include "ADT7410_Decode.hpp"
+
+#include <cmath>
+#include <cstring>
+
+typedef ADT7410_Base::Configuration C;
+
+/* Weight of a new rate of change in the smoothed one */
+static const double RATE_WEIGHT = 0.25;
+
+/* Demotion needs the rate below the threshold divided by this, so a device hovering at one does not flap */
+static const double HYSTERESIS = 2;
+
+static const uint64_t HOUR = 3600000000000ull;
+
+ADT7410_Controller::ADT7410_Controller()
+	: stable_rate(0.001), drift_rate(0.02), dwell(300000000000ull), one_shot_period(60000000000ull), burst(false)
+{
+	memset(&report, 0, sizeof(report));
+}
+
+int ADT7410_Controller::addBus(double budget)
+{
+	budgets.push_back(budget);
+	return int(budgets.size() - 1);
+}
+
+uint16_t ADT7410_Controller::addDevice(int bus, ADT7410_Shadow &shadow)
+{
+	if (bus < 0 || bus >= int(budgets.size()) || devices.size() >= INVALID_DEVICE)
+		return INVALID_DEVICE;
+	Device d;
+	d.bus = bus;
+	d.shadow = &shadow;
+	d.level = LEVEL_CONTINUOUS;
+	d.applied = LEVEL_CONTINUOUS;
+	d.configured = false;
+	d.since = 0;
+	d.rate = 0;
+	d.last = 0;
+	d.last_time = 0;
+	d.seen = false;
+	devices.push_back(d);
+	return uint16_t(devices.size() - 1);
+}
+
+void ADT7410_Controller::setRates(double stable, double drift)
+{
+	stable_rate = stable;
+	drift_rate = drift;
+}
+
+void ADT7410_Controller::setDwell(uint64_t dwell)
+{
+	this->dwell = dwell;
+}
+
+void ADT7410_Controller::setOneShotPeriod(uint64_t period)
+{
+	one_shot_period = period;
+}
+
+void ADT7410_Controller::setBurst(bool burst)
+{
+	this->burst = burst;
+}
+
+uint64_t ADT7410_Controller::period(Level level) const
+{
+	switch (level)
+	{
+	case LEVEL_ONE_SHOT: return one_shot_period;
+	case LEVEL_ONE_SPS: return ADT7410_Base::ONE_SPS_PERIOD;
+	default: return ADT7410_Base::CONVERSION_TIME;
+	}
+}
+
+double ADT7410_Controller::cost(Level level) const
+{
+	double per_sample = ADT7410_Sampler::transactions(opmode(level), burst);
+	return per_sample * double(HOUR) / double(period(level));
+}
+
+ADT7410_Controller::Level ADT7410_Controller::level(double rate) const
+{
+	return rate >= drift_rate ? LEVEL_CONTINUOUS : rate >= stable_rate ? LEVEL_ONE_SPS : LEVEL_ONE_SHOT;
+}
+
+uint8_t ADT7410_Controller::getOpmode(uint16_t device) const
+{
+	return opmode(devices[device].level);
+}
+
+uint8_t ADT7410_Controller::opmode(Level level)
+{
+	switch (level)
+	{
+	case LEVEL_ONE_SHOT: return C::OPMODE::ONE_SHOT;
+	case LEVEL_ONE_SPS: return C::OPMODE::ONE_SPS;
+	default: return C::OPMODE::CONTINOUS_CONVERSIO;
+	}
+}
+
+void ADT7410_Controller::observe(uint16_t device, int16_t temperature, uint64_t timestamp)
+{
+	if (device >= devices.size())
+		return;
+	Device &d = devices[device];
+	if (d.seen && timestamp > d.last_time)
+	{
+		double rate = fabs(double(temperature) - d.last) * (1.0 / 128) / (double(timestamp - d.last_time) * 1e-9);
+		d.rate += RATE_WEIGHT * (rate - d.rate);
+	}
+	d.last = temperature;
+	d.last_time = timestamp;
+	d.seen = true;
+}
+
+void ADT7410_Controller::observe(const ADT7410_Sample &sample)
+{
+	bool res16 = ADT7410_Base::get<C::RESOLUTION>(sample.configuration) == C::RESOLUTION::RES_16_BIT;
+	observe(sample.device, ADT7410_decode(sample.temperature, res16), sample.timestamp);
+}
+
+size_t ADT7410_Controller::update(uint64_t now)
+{
+	/* Levels wanted by the rates of change */
+	std::vector<Level> target(devices.size());
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		const Device &d = devices[i];
+		target[i] = d.level;
+		if (!d.seen)
+			continue;
+		Level wanted = level(d.rate);
+		if (wanted > d.level)
+			target[i] = wanted;
+		else if (level(d.rate * HYSTERESIS) < d.level && now - d.since >= dwell)
+			target[i] = Level(d.level - 1);
+	}
+
+	/* Demote the slowest-changing devices of buses over budget */
+	for (size_t bus = 0; bus < budgets.size(); bus++)
+	{
+		if (budgets[bus] <= 0)
+			continue;
+		double total = 0;
+		for (size_t i = 0; i < devices.size(); i++)
+			if (devices[i].bus == int(bus))
+				total += cost(target[i]);
+		while (total > budgets[bus])
+		{
+			size_t slowest = devices.size();
+			for (size_t i = 0; i < devices.size(); i++)
+				if (devices[i].bus == int(bus) && target[i] > LEVEL_ONE_SHOT
+					&& (slowest == devices.size() || devices[i].rate < devices[slowest].rate))
+					slowest = i;
+			if (slowest == devices.size())
+				break;
+			total -= cost(target[slowest]);
+			target[slowest] = Level(target[slowest] - 1);
+			total += cost(target[slowest]);
+		}
+	}
+
+	size_t writes = 0;
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		Device &d = devices[i];
+		if (target[i] != d.level)
+		{
+			if (target[i] > d.level)
+				report.promotions++;
+			else
+				report.demotions++;
+			d.level = target[i];
+			d.since = now;
+		}
+		if (d.configured && d.applied == d.level)
+			continue;
+		if (apply(d))
+			writes++;
+	}
+	return writes;
+}
+
+bool ADT7410_Controller::apply(Device &d)
+{
+	/* One-shot devices idle in shutdown, the sampler arms every conversion */
+	uint8_t opmode = d.level == LEVEL_ONE_SHOT ? C::OPMODE::SHUTDOWB
+		: d.level == LEVEL_ONE_SPS ? C::OPMODE::ONE_SPS : C::OPMODE::CONTINOUS_CONVERSIO;
+	uint8_t resolution = d.level == LEVEL_CONTINUOUS ? C::RESOLUTION::RES_16_BIT : C::RESOLUTION::RES_13_BIT;
+
+	bool written = d.shadow->modify(C::__address,
+		ADT7410_Base::modify<C::OPMODE>(opmode).set<C::RESOLUTION>(resolution));
+	if (d.shadow->error())
+	{
+		/* Unknown what Configuration holds now, read it again next time; the limits are unaffected */
+		d.shadow->invalidate(C::__address);
+		report.errors++;
+		return written;
+	}
+	if (written)
+		report.writes++;
+	else
+		report.avoided++;
+	d.applied = d.level;
+	d.configured = true;
+	return written;
+}
+
+ADT7410_Controller::Report ADT7410_Controller::getReport() const
+{
+	Report r = report;
+	r.baseline = double(devices.size()) * cost(LEVEL_CONTINUOUS);
+	r.current = 0;
+	for (size_t i = 0; i < devices.size(); i++)
+		r.current += cost(devices[i].level);
+	r.saved = r.baseline - r.current;
+	return r;
+}
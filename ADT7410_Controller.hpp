@@ -0,0 +1,156 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Controller.hpp
+ */
+
+#ifndef ADT7410_CONTROLLER_HPP
+#define ADT7410_CONTROLLER_HPP
+
+#include "ADT7410_Shadow.hpp"
+#include "ADT7410_Sampler.hpp"
+#include "ADT7410_Ring.hpp"
+
+#include <vector>
+
+/*
+ * Chooses OPMODE and RESOLUTION per device from its observed rate of change,
+ * within a transaction budget per bus.
+ *
+ * Levels, from cheapest to most detailed:
+ *   LEVEL_ONE_SHOT    13 bit, shut down between one-shot conversions every
+ *                     one-shot period (default 60 s)
+ *   LEVEL_ONE_SPS     13 bit, 1 SPS; one sample per second
+ *   LEVEL_CONTINUOUS  16 bit, continuous conversion; one sample per 240 ms
+ * The cost of a level is what ADT7410_Sampler issues per sample in its OPMODE
+ * (ADT7410_Sampler::transactions()), e.g. 3 transactions for a one-shot sample
+ * and 2 for a periodic one; setBurst() matches the samplers' snapshot reads.
+ * A device whose smoothed |dT/dt| reaches the drift rate is promoted at once,
+ * one below half the stable (drift) rate is demoted once it has held its level
+ * for the dwell time. If the devices of a bus together exceed its budget, the
+ * slowest-changing ones are demoted until it fits.
+ *
+ * Configuration is changed through the device's ADT7410_Shadow with a single
+ * OPMODE+RESOLUTION modify, so re-asserting an unchanged level never touches the
+ * bus. The caller samples each device as getOpmode()/getPeriod() say (e.g. with
+ * an ADT7410_Sampler) and feeds the results back through observe().
+ */
+class ADT7410_Controller
+{
+public:
+	enum Level
+	{
+		LEVEL_ONE_SHOT,
+		LEVEL_ONE_SPS,
+		LEVEL_CONTINUOUS,
+		LEVELS
+	};
+
+	/* Transactions per hour and counters since construction */
+	struct Report
+	{
+		double baseline;      // all devices at LEVEL_CONTINUOUS
+		double current;       // at the current levels
+		double saved;         // baseline - current
+		uint64_t writes;      // Configuration writes issued
+		uint64_t avoided;     // level changes that needed no write
+		uint64_t promotions;
+		uint64_t demotions;
+		uint64_t errors;      // Configuration writes that failed, retried on the next update()
+	};
+
+	/* Returned by addDevice() on failure */
+	enum { INVALID_DEVICE = 0xFFFF };
+
+	ADT7410_Controller();
+
+	/* Add a bus allowed budget transactions per hour (0: unlimited), returns the bus index */
+	int addBus(double budget = 0);
+
+	/* Add a device to a bus, starting at LEVEL_CONTINUOUS; returns the device id */
+	uint16_t addDevice(int bus, ADT7410_Shadow &shadow);
+
+	/* Rates of change (°C per second) for demotion and promotion, default 0.001 and 0.02 */
+	void setRates(double stable, double drift);
+
+	/* Time a device holds a level before it may be demoted (nanoseconds), default 5 minutes */
+	void setDwell(uint64_t dwell);
+
+	/* Sampling period at LEVEL_ONE_SHOT (nanoseconds), default 60 s */
+	void setOneShotPeriod(uint64_t period);
+
+	/* Whether the devices are sampled with ADT7410_Sampler::setBurst(true), for cost(); default off */
+	void setBurst(bool burst);
+
+	/* Feed a sample of a device, temperature in 1/128 °C */
+	void observe(uint16_t device, int16_t temperature, uint64_t timestamp);
+
+	/* Feed a sample whose device field is the controller's device id */
+	void observe(const ADT7410_Sample &sample);
+
+	/* Re-evaluate all devices and apply level changes, returns the number of Configuration writes */
+	size_t update(uint64_t now);
+
+	Level getLevel(uint16_t device) const
+	{
+		return devices[device].level;
+	}
+
+	/* The OPMODE to sample the device with: ONE_SHOT, ONE_SPS or CONTINOUS_CONVERSIO */
+	uint8_t getOpmode(uint16_t device) const;
+
+	/* The period to sample the device at (nanoseconds) */
+	uint64_t getPeriod(uint16_t device) const
+	{
+		return period(devices[device].level);
+	}
+
+	/* Smoothed rate of change (°C per second) */
+	double getRate(uint16_t device) const
+	{
+		return devices[device].rate;
+	}
+
+	Report getReport() const;
+
+	/* Transactions per hour of a device at a level */
+	double cost(Level level) const;
+
+private:
+	struct Device
+	{
+		int bus;
+		ADT7410_Shadow *shadow;
+		Level level;
+		Level applied;        // level the device is configured for
+		bool configured;
+		uint64_t since;       // time of the last level change
+		double rate;
+		int16_t last;
+		uint64_t last_time;
+		bool seen;
+	};
+
+	uint64_t period(Level level) const;
+	static uint8_t opmode(Level level);
+
+	/* Level wanted at a rate of change */
+	Level level(double rate) const;
+	bool apply(Device &d);
+
+	std::vector<double> budgets;
+	std::vector<Device> devices;
+	double stable_rate;
+	double drift_rate;
+	uint64_t dwell;
+	uint64_t one_shot_period;
+	bool burst;
+	Report report;
+};
+
+#endif /* ADT7410_CONTROLLER_HPP */
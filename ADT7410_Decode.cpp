@@ -0,0 +1,208 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Decode.cpp
+ */
+
+#include "ADT7410_Decode.hpp"
+
+/*
+ * The vector kernel is chosen at compile time from the target flags
+ * (-mavx2, SSE2 is the x86-64 baseline, NEON on AArch64/-mfpu=neon).
+ * Every kernel decodes whole vectors and leaves the tail to the scalar loop.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ADT7410_DECODE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ADT7410_DECODE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ADT7410_DECODE_NEON
+#endif
+
+static const uint16_t FLAG_MASK =
+	ADT7410_Base::TEMPERATURE::TLOWFLAG_LSB0::mask |
+	ADT7410_Base::TEMPERATURE::THIGHFLAG_LSB1::mask |
+	ADT7410_Base::TEMPERATURE::TCRITFLAG_LSB2::mask;
+
+#if defined(ADT7410_DECODE_AVX2)
+
+static size_t decodeVector(const uint16_t *raw, int16_t *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const __m256i value_mask = _mm256_set1_epi16(short(mask));
+	const __m256i flag_mask = _mm256_set1_epi16(short(~mask & FLAG_MASK));
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(raw + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_and_si256(v, value_mask));
+		if (flags)
+		{
+			__m256i f = _mm256_and_si256(v, flag_mask);
+			__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(flags + i), packed);
+		}
+	}
+	return i;
+}
+
+static size_t decodeVectorFloat(const uint16_t *raw, float *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const __m256i value_mask = _mm256_set1_epi16(short(mask));
+	const __m256i flag_mask = _mm256_set1_epi16(short(~mask & FLAG_MASK));
+	const __m256 scale = _mm256_set1_ps(1.0f / 128);
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(raw + i));
+		__m256i t = _mm256_and_si256(v, value_mask);
+		__m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(t));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(t, 1));
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+		_mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+		if (flags)
+		{
+			__m256i f = _mm256_and_si256(v, flag_mask);
+			__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(flags + i), packed);
+		}
+	}
+	return i;
+}
+
+#elif defined(ADT7410_DECODE_SSE2)
+
+static size_t decodeVector(const uint16_t *raw, int16_t *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const __m128i value_mask = _mm_set1_epi16(short(mask));
+	const __m128i flag_mask = _mm_set1_epi16(short(~mask & FLAG_MASK));
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raw + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_and_si128(v, value_mask));
+		if (flags)
+		{
+			__m128i f = _mm_and_si128(v, flag_mask);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(flags + i), _mm_packus_epi16(f, f));
+		}
+	}
+	return i;
+}
+
+static size_t decodeVectorFloat(const uint16_t *raw, float *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const __m128i value_mask = _mm_set1_epi16(short(mask));
+	const __m128i flag_mask = _mm_set1_epi16(short(~mask & FLAG_MASK));
+	const __m128 scale = _mm_set1_ps(1.0f / 128);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raw + i));
+		__m128i t = _mm_and_si128(v, value_mask);
+		/* Sign extend: place each word in the upper half of a dword, then shift down arithmetically */
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(t, t), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(t, t), 16);
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		if (flags)
+		{
+			__m128i f = _mm_and_si128(v, flag_mask);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(flags + i), _mm_packus_epi16(f, f));
+		}
+	}
+	return i;
+}
+
+#elif defined(ADT7410_DECODE_NEON)
+
+static size_t decodeVector(const uint16_t *raw, int16_t *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const uint16x8_t value_mask = vdupq_n_u16(mask);
+	const uint16x8_t flag_mask = vdupq_n_u16(uint16_t(~mask & FLAG_MASK));
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		uint16x8_t v = vld1q_u16(raw + i);
+		vst1q_s16(out + i, vreinterpretq_s16_u16(vandq_u16(v, value_mask)));
+		if (flags)
+			vst1_u8(flags + i, vmovn_u16(vandq_u16(v, flag_mask)));
+	}
+	return i;
+}
+
+static size_t decodeVectorFloat(const uint16_t *raw, float *out, size_t n, uint16_t mask, uint8_t *flags)
+{
+	const uint16x8_t value_mask = vdupq_n_u16(mask);
+	const uint16x8_t flag_mask = vdupq_n_u16(uint16_t(~mask & FLAG_MASK));
+	const float32x4_t scale = vdupq_n_f32(1.0f / 128);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		uint16x8_t v = vld1q_u16(raw + i);
+		int16x8_t t = vreinterpretq_s16_u16(vandq_u16(v, value_mask));
+		vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(t))), scale));
+		vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(t))), scale));
+		if (flags)
+			vst1_u8(flags + i, vmovn_u16(vandq_u16(v, flag_mask)));
+	}
+	return i;
+}
+
+#else
+
+static size_t decodeVector(const uint16_t *, int16_t *, size_t, uint16_t, uint8_t *)
+{
+	return 0;
+}
+
+static size_t decodeVectorFloat(const uint16_t *, float *, size_t, uint16_t, uint8_t *)
+{
+	return 0;
+}
+
+#endif
+
+void ADT7410_decode(const uint16_t *raw, int16_t *out, size_t n, bool res16, uint8_t *flags)
+{
+	uint16_t mask = ADT7410_temperatureMask(res16);
+	uint16_t flag_mask = uint16_t(~mask & FLAG_MASK);
+	for (size_t i = decodeVector(raw, out, n, mask, flags); i < n; i++)
+	{
+		out[i] = int16_t(raw[i] & mask);
+		if (flags)
+			flags[i] = uint8_t(raw[i] & flag_mask);
+	}
+}
+
+void ADT7410_decodeFloat(const uint16_t *raw, float *out, size_t n, bool res16, uint8_t *flags)
+{
+	uint16_t mask = ADT7410_temperatureMask(res16);
+	uint16_t flag_mask = uint16_t(~mask & FLAG_MASK);
+	for (size_t i = decodeVectorFloat(raw, out, n, mask, flags); i < n; i++)
+	{
+		out[i] = float(int16_t(raw[i] & mask)) * (1.0f / 128);
+		if (flags)
+			flags[i] = uint8_t(raw[i] & flag_mask);
+	}
+}
+
+const char *ADT7410_decodeKernel()
+{
+#if defined(ADT7410_DECODE_AVX2)
+	return "avx2";
+#elif defined(ADT7410_DECODE_SSE2)
+	return "sse2";
+#elif defined(ADT7410_DECODE_NEON)
+	return "neon";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,58 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Decode.hpp
+ */
+
+#ifndef ADT7410_DECODE_HPP
+#define ADT7410_DECODE_HPP
+
+#include "ADT7410.hpp"
+
+#include <cstddef>
+
+/*
+ * Decoding of raw TEMPERATURE words.
+ * Both resolutions share one fixed point format of 1/128 °C: in 16-bit mode the
+ * word is the two's complement value itself, in 13-bit mode the three low bits
+ * are TLOWFLAG/THIGHFLAG/TCRITFLAG and the rest is the value in steps of 1/16 °C,
+ * i.e. 8/128 °C. Decoding is therefore a mask and a sign extension.
+ */
+
+/* Mask of the temperature bits for a Configuration::RESOLUTION value */
+inline uint16_t ADT7410_temperatureMask(bool res16)
+{
+	return res16 ? 0xFFFF : uint16_t(ADT7410_Base::TEMPERATURE::TEMPERATURE_::mask | ADT7410_Base::TEMPERATURE::SIGN::mask);
+}
+
+/* Decode one raw word to 1/128 °C */
+inline int16_t ADT7410_decode(uint16_t raw, bool res16)
+{
+	return int16_t(raw & ADT7410_temperatureMask(res16));
+}
+
+/* Decode one raw word to °C */
+inline float ADT7410_decodeFloat(uint16_t raw, bool res16)
+{
+	return float(ADT7410_decode(raw, res16)) * (1.0f / 128);
+}
+
+/*
+ * Decode n raw words to 1/128 °C.
+ * If flags is not null it receives one byte per sample holding the TLOWFLAG,
+ * THIGHFLAG and TCRITFLAG bits (bits 0-2, always 0 in 16-bit mode).
+ */
+void ADT7410_decode(const uint16_t *raw, int16_t *out, size_t n, bool res16, uint8_t *flags = 0);
+
+/* Decode n raw words to °C, flags as above */
+void ADT7410_decodeFloat(const uint16_t *raw, float *out, size_t n, bool res16, uint8_t *flags = 0);
+
+/* Name of the kernel selected at compile time: "avx2", "sse2", "neon" or "scalar" */
+const char *ADT7410_decodeKernel();
+
+#endif /* ADT7410_DECODE_HPP */
@@ -0,0 +1,191 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Descriptor.cpp
+ */
+
+#include "ADT7410_Descriptor.hpp"
+
+#include <cstring>
+
+typedef ADT7410_Registers R;
+typedef ADT7410_RegisterDescriptor D;
+
+/* A field with a default, and one without */
+#define ADT7410_FIELD(REG, FIELD, DESCRIPTION, VALUES, COUNT) \
+	{ #FIELD, DESCRIPTION, R::REG::FIELD::mask, R::REG::FIELD::dflt, true, VALUES, COUNT }
+#define ADT7410_FIELD_NODEFAULT(REG, FIELD, DESCRIPTION) \
+	{ #FIELD, DESCRIPTION, R::REG::FIELD::mask, 0, false, 0, 0 }
+
+/* Default of a field in register position */
+#define ADT7410_DEFAULT(REG, FIELD) \
+	(R::REG::FIELD::dflt << ADT7410_Shift<R::REG::FIELD::mask>::value)
+
+#define ADT7410_COUNT(ARRAY) (sizeof(ARRAY) / sizeof(ARRAY[0]))
+
+/****************************************************************************************************\
+ *                                          FIELD VALUES                                            *
+\****************************************************************************************************/
+
+static const ADT7410_ValueDescriptor FAULT_QUEUE_VALUES[] =
+{
+	{ "FAULTS_1", R::Configuration::FAULT_QUEUE::FAULTS_1 },
+	{ "FAULTS_2", R::Configuration::FAULT_QUEUE::FAULTS_2 },
+	{ "FAULTS_3", R::Configuration::FAULT_QUEUE::FAULTS_3 },
+	{ "FAULTS_4", R::Configuration::FAULT_QUEUE::FAULTS_4 },
+};
+
+static const ADT7410_ValueDescriptor POLARITY_VALUES[] =
+{
+	{ "ACTIVE_LOW", R::Configuration::CT_PIN_POLARITY::ACTIVE_LOW },
+	{ "ACTIVE_HIGH", R::Configuration::CT_PIN_POLARITY::ACTIVE_HIGH },
+};
+
+static const ADT7410_ValueDescriptor INT_CT_MODE_VALUES[] =
+{
+	{ "INTERRUPT_MODE", R::Configuration::INT_CT_MODE::INTERRUPT_MODE },
+	{ "COMPARATOR_MODE", R::Configuration::INT_CT_MODE::COMPARATOR_MODE },
+};
+
+static const ADT7410_ValueDescriptor OPMODE_VALUES[] =
+{
+	{ "CONTINOUS_CONVERSIO", R::Configuration::OPMODE::CONTINOUS_CONVERSIO },
+	{ "ONE_SHOT", R::Configuration::OPMODE::ONE_SHOT },
+	{ "ONE_SPS", R::Configuration::OPMODE::ONE_SPS },
+	{ "SHUTDOWB", R::Configuration::OPMODE::SHUTDOWB },
+};
+
+static const ADT7410_ValueDescriptor RESOLUTION_VALUES[] =
+{
+	{ "RES_13_BIT", R::Configuration::RESOLUTION::RES_13_BIT },
+	{ "RES_16_BIT", R::Configuration::RESOLUTION::RES_16_BIT },
+};
+
+/****************************************************************************************************\
+ *                                             FIELDS                                               *
+\****************************************************************************************************/
+
+static const ADT7410_FieldDescriptor TEMPERATURE_FIELDS[] =
+{
+	ADT7410_FIELD(TEMPERATURE, TLOWFLAG_LSB0, "TLOW flag in 13-bit comparator mode, else LSB 0", 0, 0),
+	ADT7410_FIELD(TEMPERATURE, THIGHFLAG_LSB1, "THIGH flag in 13-bit comparator mode, else LSB 1", 0, 0),
+	ADT7410_FIELD(TEMPERATURE, TCRITFLAG_LSB2, "TCRIT flag in 13-bit comparator mode, else LSB 2", 0, 0),
+	ADT7410_FIELD(TEMPERATURE, TEMPERATURE_, "Temperature value", 0, 0),
+	ADT7410_FIELD(TEMPERATURE, SIGN, "Sign bit", 0, 0),
+};
+
+/* The generated names of bits 4 and 5 are swapped with respect to the datasheet, the descriptions are not */
+static const ADT7410_FieldDescriptor STATUS_FIELDS[] =
+{
+	ADT7410_FIELD(Status, unused_0, "Unused", 0, 0),
+	ADT7410_FIELD(Status, THIGH, "Temperature below TLOW", 0, 0),
+	ADT7410_FIELD(Status, TLOW, "Temperature above THIGH", 0, 0),
+	ADT7410_FIELD(Status, TCRIT, "Temperature above TCRIT", 0, 0),
+	ADT7410_FIELD(Status, nRDY, "Conversion result not ready", 0, 0),
+};
+
+static const ADT7410_FieldDescriptor CONFIGURATION_FIELDS[] =
+{
+	ADT7410_FIELD(Configuration, FAULT_QUEUE, "Undertemperature/overtemperature faults before INT and CT assert",
+		FAULT_QUEUE_VALUES, ADT7410_COUNT(FAULT_QUEUE_VALUES)),
+	ADT7410_FIELD(Configuration, CT_PIN_POLARITY, "CT pin polarity", POLARITY_VALUES, ADT7410_COUNT(POLARITY_VALUES)),
+	ADT7410_FIELD(Configuration, INT_PIN_POLARITY, "INT pin polarity", POLARITY_VALUES, ADT7410_COUNT(POLARITY_VALUES)),
+	ADT7410_FIELD(Configuration, INT_CT_MODE, "INT/CT mode", INT_CT_MODE_VALUES, ADT7410_COUNT(INT_CT_MODE_VALUES)),
+	ADT7410_FIELD(Configuration, OPMODE, "Operation mode", OPMODE_VALUES, ADT7410_COUNT(OPMODE_VALUES)),
+	ADT7410_FIELD(Configuration, RESOLUTION, "Resolution", RESOLUTION_VALUES, ADT7410_COUNT(RESOLUTION_VALUES)),
+};
+
+static const ADT7410_FieldDescriptor THIGH_FIELDS[] =
+{
+	ADT7410_FIELD(THIGH, THIGH_, "Overtemperature limit", 0, 0),
+};
+
+static const ADT7410_FieldDescriptor TLOW_FIELDS[] =
+{
+	ADT7410_FIELD(TLOW, TLOW_, "Undertemperature limit", 0, 0),
+};
+
+static const ADT7410_FieldDescriptor TCRIT_FIELDS[] =
+{
+	ADT7410_FIELD(TCRIT, TCRIT_, "Critical overtemperature limit", 0, 0),
+};
+
+static const ADT7410_FieldDescriptor THYST_FIELDS[] =
+{
+	ADT7410_FIELD(THYST, HYSTERESIS, "Hysteresis, 0 to 15 °C", 0, 0),
+	ADT7410_FIELD(THYST, unused_0, "Unused", 0, 0),
+};
+
+static const ADT7410_FieldDescriptor ID_FIELDS[] =
+{
+	ADT7410_FIELD_NODEFAULT(ID, REVISION_ID, "Silicon revision"),
+	ADT7410_FIELD(ID, MANUFACTURER_ID, "Manufacturer identification", 0, 0),
+};
+
+/****************************************************************************************************\
+ *                                            REGISTERS                                             *
+\****************************************************************************************************/
+
+const ADT7410_RegisterDescriptor ADT7410_registers[] =
+{
+	{ "TEMPERATURE", R::TEMPERATURE::__address, 16, D::READ, true, D::TEMPERATURE,
+		ADT7410_DEFAULT(TEMPERATURE, TEMPERATURE_) | ADT7410_DEFAULT(TEMPERATURE, SIGN),
+		TEMPERATURE_FIELDS, ADT7410_COUNT(TEMPERATURE_FIELDS) },
+	{ "Status", R::Status::__address, 8, D::READ, true, D::RAW,
+		ADT7410_DEFAULT(Status, nRDY),
+		STATUS_FIELDS, ADT7410_COUNT(STATUS_FIELDS) },
+	{ "Configuration", R::Configuration::__address, 8, D::READ | D::WRITE, false, D::RAW,
+		ADT7410_DEFAULT(Configuration, FAULT_QUEUE) | ADT7410_DEFAULT(Configuration, CT_PIN_POLARITY)
+			| ADT7410_DEFAULT(Configuration, INT_PIN_POLARITY) | ADT7410_DEFAULT(Configuration, INT_CT_MODE)
+			| ADT7410_DEFAULT(Configuration, OPMODE) | ADT7410_DEFAULT(Configuration, RESOLUTION),
+		CONFIGURATION_FIELDS, ADT7410_COUNT(CONFIGURATION_FIELDS) },
+	{ "THIGH", R::THIGH::__address, 16, D::READ | D::WRITE, false, D::TEMPERATURE,
+		ADT7410_DEFAULT(THIGH, THIGH_),
+		THIGH_FIELDS, ADT7410_COUNT(THIGH_FIELDS) },
+	{ "TLOW", R::TLOW::__address, 16, D::READ | D::WRITE, false, D::TEMPERATURE,
+		ADT7410_DEFAULT(TLOW, TLOW_),
+		TLOW_FIELDS, ADT7410_COUNT(TLOW_FIELDS) },
+	{ "TCRIT", R::TCRIT::__address, 16, D::READ | D::WRITE, false, D::TEMPERATURE,
+		ADT7410_DEFAULT(TCRIT, TCRIT_),
+		TCRIT_FIELDS, ADT7410_COUNT(TCRIT_FIELDS) },
+	{ "THYST", R::THYST::__address, 8, D::READ | D::WRITE, false, D::HYSTERESIS,
+		ADT7410_DEFAULT(THYST, HYSTERESIS) | ADT7410_DEFAULT(THYST, unused_0),
+		THYST_FIELDS, ADT7410_COUNT(THYST_FIELDS) },
+	{ "ID", R::ID::__address, 8, D::READ, false, D::RAW,
+		ADT7410_DEFAULT(ID, MANUFACTURER_ID),
+		ID_FIELDS, ADT7410_COUNT(ID_FIELDS) },
+	{ "RESET", R::RESET::__address, 0, D::WRITE, false, D::RAW,
+		0,
+		0, 0 },
+};
+
+const size_t ADT7410_registerCount = ADT7410_COUNT(ADT7410_registers);
+
+const ADT7410_RegisterDescriptor *ADT7410_findRegister(uint16_t address)
+{
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+		if (ADT7410_registers[i].address == address)
+			return &ADT7410_registers[i];
+	return 0;
+}
+
+const ADT7410_RegisterDescriptor *ADT7410_findRegister(const char *name)
+{
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+		if (strcmp(ADT7410_registers[i].name, name) == 0)
+			return &ADT7410_registers[i];
+	return 0;
+}
+
+const char *ADT7410_valueName(const ADT7410_FieldDescriptor &field, uint16_t value)
+{
+	for (size_t i = 0; i < field.valueCount; i++)
+		if (field.values[i].value == value)
+			return field.values[i].name;
+	return 0;
+}
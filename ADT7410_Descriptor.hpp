@@ -0,0 +1,78 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Descriptor.hpp
+ */
+
+#ifndef ADT7410_DESCRIPTOR_HPP
+#define ADT7410_DESCRIPTOR_HPP
+
+#include "ADT7410.hpp"
+
+#include <cstddef>
+
+/*
+ * Register metadata as constant tables, for tooling that walks the register map
+ * instead of naming every register. The entries are built from the constants of
+ * ADT7410_Registers, so they cannot drift from them; names are the C++ names.
+ */
+
+/* A named value of a field */
+struct ADT7410_ValueDescriptor
+{
+	const char *name;
+	uint8_t value;
+};
+
+struct ADT7410_FieldDescriptor
+{
+	const char *name;
+	const char *description;
+	uint16_t mask;
+	uint16_t dflt;
+	bool hasDefault;
+	const ADT7410_ValueDescriptor *values;  // named values, 0 if none
+	size_t valueCount;
+};
+
+struct ADT7410_RegisterDescriptor
+{
+	/* Access bits */
+	enum { READ = 1, WRITE = 2 };
+
+	/* How the register value reads as a whole */
+	enum Format
+	{
+		RAW,
+		TEMPERATURE,  // two's complement, 1/128 °C (13-bit results carry flags in bits 0 to 2)
+		HYSTERESIS    // HYSTERESIS field in °C
+	};
+
+	const char *name;
+	uint16_t address;
+	uint8_t width;        // bits, 0 for the RESET command
+	uint8_t access;
+	bool isVolatile;      // reading has side effects or the value changes by itself
+	Format format;
+	uint16_t dflt;        // power-on value, from the field defaults
+	const ADT7410_FieldDescriptor *fields;
+	size_t fieldCount;
+};
+
+/* All registers in address order, RESET last */
+extern const ADT7410_RegisterDescriptor ADT7410_registers[];
+extern const size_t ADT7410_registerCount;
+
+/* Look a register up by address or name, 0 if none */
+const ADT7410_RegisterDescriptor *ADT7410_findRegister(uint16_t address);
+const ADT7410_RegisterDescriptor *ADT7410_findRegister(const char *name);
+
+/* Name of a field value, 0 if it has none */
+const char *ADT7410_valueName(const ADT7410_FieldDescriptor &field, uint16_t value);
+
+#endif /* ADT7410_DESCRIPTOR_HPP */
@@ -0,0 +1,482 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Events.cpp
+ */
+
+#include "ADT7410_Events.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+typedef ADT7410_Base::Configuration Configuration;
+
+/* Bound on re-reading an interrupt-mode line that stays active */
+static const int MAX_REREADS = 4;
+
+/* Edges taken from the source at once */
+static const size_t EVENT_BATCH = 32;
+
+/****************************************************************************************************\
+ *                                           GPIO LINES                                             *
+\****************************************************************************************************/
+
+ADT7410_GPIOLines::ADT7410_GPIOLines(const char *chip, const uint32_t *lines, size_t count, bool pullUp)
+	: fd(-1), last_error(0), offsets(lines, lines + count)
+{
+	if (count == 0 || count > GPIO_V2_LINES_MAX)
+	{
+		last_error = EINVAL;
+		return;
+	}
+	int chip_fd = open(chip, O_RDONLY | O_CLOEXEC);
+	if (chip_fd < 0)
+	{
+		last_error = errno;
+		return;
+	}
+
+	struct gpio_v2_line_request request;
+	memset(&request, 0, sizeof(request));
+	for (size_t i = 0; i < count; i++)
+		request.offsets[i] = lines[i];
+	request.num_lines = uint32_t(count);
+	strncpy(request.consumer, "adt7410", sizeof(request.consumer) - 1);
+	request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	if (pullUp)
+		request.config.flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+
+	if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+		last_error = errno;
+	else
+	{
+		fd = request.fd;
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	}
+	close(chip_fd);
+}
+
+ADT7410_GPIOLines::~ADT7410_GPIOLines()
+{
+	if (fd >= 0)
+		close(fd);
+}
+
+size_t ADT7410_GPIOLines::readEvents(ADT7410_LineEvent *events, size_t max)
+{
+	struct gpio_v2_line_event buffer[EVENT_BATCH];
+	size_t n = 0;
+	while (fd >= 0 && n < max)
+	{
+		size_t want = max - n < EVENT_BATCH ? max - n : EVENT_BATCH;
+		ssize_t length = read(fd, buffer, want * sizeof(buffer[0]));
+		if (length <= 0)
+			break;
+		size_t got = size_t(length) / sizeof(buffer[0]);
+		for (size_t i = 0; i < got; i++, n++)
+		{
+			events[n].line = buffer[i].offset;
+			events[n].rising = buffer[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE;
+			events[n].timestamp = buffer[i].timestamp_ns;
+		}
+		if (got < want)
+			break;
+	}
+	return n;
+}
+
+int ADT7410_GPIOLines::getLevel(uint32_t line)
+{
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		if (offsets[i] != line)
+			continue;
+		struct gpio_v2_line_values values;
+		values.bits = 0;
+		values.mask = 1ull << i;
+		if (fd < 0 || ioctl(fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0)
+			return -1;
+		return int((values.bits >> i) & 1);
+	}
+	return -1;
+}
+
+/****************************************************************************************************\
+ *                                          EVENTFD LINES                                           *
+\****************************************************************************************************/
+
+ADT7410_EventFdLines::ADT7410_EventFdLines(uint32_t count, int level)
+	: fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), levels(count, level ? 1 : 0)
+{
+	pthread_mutex_init(&lock, 0);
+}
+
+ADT7410_EventFdLines::~ADT7410_EventFdLines()
+{
+	if (fd >= 0)
+		close(fd);
+	pthread_mutex_destroy(&lock);
+}
+
+void ADT7410_EventFdLines::setLevel(uint32_t line, int level, uint64_t timestamp)
+{
+	level = level ? 1 : 0;
+	pthread_mutex_lock(&lock);
+	if (line >= levels.size() || levels[line] == level)
+	{
+		pthread_mutex_unlock(&lock);
+		return;
+	}
+	levels[line] = level;
+	ADT7410_LineEvent event;
+	event.line = line;
+	event.rising = level != 0;
+	event.timestamp = timestamp ? timestamp : ADT7410_now();
+	pending.push_back(event);
+	pthread_mutex_unlock(&lock);
+
+	uint64_t one = 1;
+	ssize_t written = write(fd, &one, sizeof(one));
+	(void)written;
+}
+
+size_t ADT7410_EventFdLines::readEvents(ADT7410_LineEvent *events, size_t max)
+{
+	uint64_t count;
+	ssize_t length = read(fd, &count, sizeof(count));
+	(void)length;
+
+	pthread_mutex_lock(&lock);
+	size_t n = 0;
+	for (; n < max && !pending.empty(); n++)
+	{
+		events[n] = pending.front();
+		pending.pop_front();
+	}
+	bool more = !pending.empty();
+	pthread_mutex_unlock(&lock);
+
+	/* Stay readable for what did not fit */
+	if (more)
+	{
+		uint64_t one = 1;
+		ssize_t written = write(fd, &one, sizeof(one));
+		(void)written;
+	}
+	return n;
+}
+
+int ADT7410_EventFdLines::getLevel(uint32_t line)
+{
+	pthread_mutex_lock(&lock);
+	int level = line < levels.size() ? levels[line] : -1;
+	pthread_mutex_unlock(&lock);
+	return level;
+}
+
+/****************************************************************************************************\
+ *                                          ALARM EVENTS                                            *
+\****************************************************************************************************/
+
+ADT7410_AlarmEvents::ADT7410_AlarmEvents(ADT7410_LineSource &source, ADT7410_SampleSink &sink)
+	: source(source), sink(sink), hold_period(1000000000u)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+uint16_t ADT7410_AlarmEvents::addDevice(ADT7410_Base &device)
+{
+	uint8_t configuration;
+	if (devices.size() >= INVALID_DEVICE || device.tryRead8(Configuration::__address, configuration))
+		return INVALID_DEVICE;
+	Device d;
+	d.device = &device;
+	d.configuration = configuration;
+	d.pending = false;
+	devices.push_back(d);
+	return uint16_t(devices.size() - 1);
+}
+
+bool ADT7410_AlarmEvents::attach(uint16_t device, Pin pin, uint32_t line)
+{
+	if (device >= devices.size())
+		return false;
+	Attachment a;
+	a.device = device;
+	a.pin = pin;
+
+	/* An open-drain line shared by pins of opposite polarity has no meaningful level */
+	Line *l = find(line);
+	if (l && !l->attached.empty() && activeHigh(a) != activeHigh(l->attached[0]))
+		return false;
+	if (!l)
+	{
+		Line created;
+		created.id = line;
+		created.touched = false;
+		created.held = false;
+		created.next = 0;
+		lines.push_back(created);
+		l = &lines.back();
+	}
+	l->attached.push_back(a);
+	return true;
+}
+
+bool ADT7410_AlarmEvents::setConfiguration(uint16_t device, uint8_t configuration)
+{
+	if (device >= devices.size())
+		return false;
+	if (conflicts(device, configuration))
+	{
+		stats.conflicts++;
+		return false;
+	}
+	devices[device].configuration = configuration;
+	return true;
+}
+
+void ADT7410_AlarmEvents::setHoldPeriod(uint64_t period)
+{
+	hold_period = period;
+}
+
+ADT7410_AlarmEvents::Line *ADT7410_AlarmEvents::find(uint32_t line)
+{
+	for (size_t i = 0; i < lines.size(); i++)
+		if (lines[i].id == line)
+			return &lines[i];
+	return 0;
+}
+
+bool ADT7410_AlarmEvents::activeHigh(uint8_t configuration, Pin pin)
+{
+	if (pin == CT)
+		return ADT7410_Base::get<Configuration::CT_PIN_POLARITY>(configuration) == Configuration::CT_PIN_POLARITY::ACTIVE_HIGH;
+	return ADT7410_Base::get<Configuration::INT_PIN_POLARITY>(configuration) == Configuration::INT_PIN_POLARITY::ACTIVE_HIGH;
+}
+
+bool ADT7410_AlarmEvents::activeHigh(const Attachment &a) const
+{
+	return activeHigh(devices[a.device].configuration, a.pin);
+}
+
+/* Whether a new Configuration of a device would leave one of its lines with pins of both polarities */
+bool ADT7410_AlarmEvents::conflicts(uint16_t device, uint8_t configuration) const
+{
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		const std::vector<Attachment> &attached = lines[i].attached;
+		bool any = false, high = false, low = false;
+		for (size_t j = 0; j < attached.size(); j++)
+		{
+			bool mine = attached[j].device == device;
+			bool polarity = mine ? activeHigh(configuration, attached[j].pin) : activeHigh(attached[j]);
+			any = any || mine;
+			high = high || polarity;
+			low = low || !polarity;
+		}
+		if (any && high && low)
+			return true;
+	}
+	return false;
+}
+
+bool ADT7410_AlarmEvents::comparator(const Attachment &a) const
+{
+	return a.pin == CT || ADT7410_Base::get<Configuration::INT_CT_MODE>(devices[a.device].configuration)
+		== Configuration::INT_CT_MODE::COMPARATOR_MODE;
+}
+
+/* All pins on a line have the same polarity: attach(), setConfiguration() and readPending() keep it so */
+bool ADT7410_AlarmEvents::isActive(const Line &line)
+{
+	if (line.attached.empty())
+		return false;
+	int level = source.getLevel(line.id);
+	return level >= 0 && (level == 1) == activeHigh(line.attached[0]);
+}
+
+size_t ADT7410_AlarmEvents::mark(const Line &line, bool comparators)
+{
+	size_t n = 0;
+	for (size_t i = 0; i < line.attached.size(); i++)
+	{
+		if (comparator(line.attached[i]) != comparators)
+			continue;
+		devices[line.attached[i].device].pending = true;
+		n++;
+	}
+	return n;
+}
+
+void ADT7410_AlarmEvents::edge(const ADT7410_LineEvent &event)
+{
+	Line *line = find(event.line);
+	if (!line)
+		return;
+	stats.edges++;
+	line->touched = true;
+
+	/* Assert edges are read; release edges only where the pin follows the condition */
+	bool read = false;
+	for (size_t i = 0; i < line->attached.size(); i++)
+	{
+		const Attachment &a = line->attached[i];
+		if (event.rising == activeHigh(a) || comparator(a))
+		{
+			devices[a.device].pending = true;
+			read = true;
+		}
+	}
+	if (!read)
+		stats.ignored++;
+}
+
+int ADT7410_AlarmEvents::readPending()
+{
+	int reads = 0;
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		Device &d = devices[i];
+		if (!d.pending)
+			continue;
+		d.pending = false;
+		ADT7410_Base::Snapshot snapshot;
+		stats.reads++;
+		if (d.device->tryReadSnapshot(snapshot))
+		{
+			stats.errors++;
+			continue;
+		}
+		if (!conflicts(uint16_t(i), snapshot.configuration))
+			d.configuration = snapshot.configuration;
+		else
+		{
+			/* Keep interpreting the lines with the polarities they were attached with */
+			const uint8_t polarities = uint8_t(Configuration::CT_PIN_POLARITY::mask | Configuration::INT_PIN_POLARITY::mask);
+			d.configuration = uint8_t((snapshot.configuration & ~polarities) | (d.configuration & polarities));
+			stats.conflicts++;
+		}
+		sink.sample(uint16_t(i), snapshot, ADT7410_now());
+		reads++;
+	}
+	return reads;
+}
+
+/* After the devices of a line were read: re-read an interrupt-mode line that stayed active, track held comparator lines */
+int ADT7410_AlarmEvents::settle(Line &line, uint64_t now)
+{
+	int reads = 0;
+	bool active = isActive(line);
+	for (int i = 0; active && i < MAX_REREADS; i++)
+	{
+		if (!mark(line, false))
+			break;
+		stats.rereads++;
+		reads += readPending();
+		active = isActive(line);
+	}
+
+	bool held = active;
+	if (held)
+	{
+		held = false;
+		for (size_t i = 0; i < line.attached.size() && !held; i++)
+			held = comparator(line.attached[i]);
+	}
+	if (held && !line.held)
+		line.next = now + hold_period;
+	line.held = held;
+	line.touched = false;
+	return reads;
+}
+
+int ADT7410_AlarmEvents::serviceHeld(uint64_t now)
+{
+	int reads = 0;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		Line &line = lines[i];
+		if (!line.held || line.next > now)
+			continue;
+		stats.holds += mark(line, true);
+		reads += readPending();
+		line.next = now + hold_period;
+		if (!isActive(line))
+			line.held = false;
+	}
+	return reads;
+}
+
+int ADT7410_AlarmEvents::sync()
+{
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		lines[i].touched = true;
+		if (!isActive(lines[i]))
+			continue;
+		for (size_t j = 0; j < lines[i].attached.size(); j++)
+			devices[lines[i].attached[j].device].pending = true;
+	}
+	int reads = readPending();
+	uint64_t now = ADT7410_now();
+	for (size_t i = 0; i < lines.size(); i++)
+		reads += settle(lines[i], now);
+	return reads;
+}
+
+int ADT7410_AlarmEvents::process()
+{
+	ADT7410_LineEvent events[EVENT_BATCH];
+	size_t n;
+	do
+	{
+		n = source.readEvents(events, EVENT_BATCH);
+		for (size_t i = 0; i < n; i++)
+			edge(events[i]);
+	}
+	while (n == EVENT_BATCH);
+
+	int reads = readPending();
+	uint64_t now = ADT7410_now();
+	for (size_t i = 0; i < lines.size(); i++)
+		if (lines[i].touched)
+			reads += settle(lines[i], now);
+	return reads + serviceHeld(now);
+}
+
+int ADT7410_AlarmEvents::wait(uint64_t timeout)
+{
+	uint64_t now = ADT7410_now();
+	uint64_t deadline = now + timeout;
+	for (size_t i = 0; i < lines.size(); i++)
+		if (lines[i].held && lines[i].next < deadline)
+			deadline = lines[i].next;
+
+	int milliseconds = 0;
+	if (deadline > now)
+	{
+		uint64_t rounded = (deadline - now + 999999) / 1000000;
+		milliseconds = rounded > 0x7FFFFFFF ? 0x7FFFFFFF : int(rounded);
+	}
+	struct pollfd fds;
+	fds.fd = source.getFd();
+	fds.events = POLLIN;
+	fds.revents = 0;
+	if (poll(&fds, 1, milliseconds) < 0 && errno != EINTR)
+		return -1;
+	return process();
+}
@@ -0,0 +1,250 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Events.hpp
+ */
+
+#ifndef ADT7410_EVENTS_HPP
+#define ADT7410_EVENTS_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Acquisition.hpp"
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+/* An edge on a host input line */
+struct ADT7410_LineEvent
+{
+	uint32_t line;
+	bool rising;
+	uint64_t timestamp;  // nanoseconds, CLOCK_MONOTONIC
+};
+
+/* Host input lines wired to INT/CT pins, delivering their edges through a pollable descriptor */
+class ADT7410_LineSource
+{
+public:
+	virtual ~ADT7410_LineSource()
+	{
+	}
+
+	/* Descriptor that polls readable while edges are pending, -1 if not open */
+	virtual int getFd() const = 0;
+
+	/* Take pending edges without blocking, returns the number stored */
+	virtual size_t readEvents(ADT7410_LineEvent *events, size_t max) = 0;
+
+	/* Current level of a line: 0, 1, or -1 on error */
+	virtual int getLevel(uint32_t line) = 0;
+};
+
+/*
+ * Lines of a GPIO chip through the Linux GPIO character device (uAPI v2).
+ * The lines are requested as inputs with edge detection on both edges, line ids
+ * are the offsets on the chip. INT and CT are open-drain, pullUp enables the
+ * chip's bias where the board has no external pull-up.
+ */
+class ADT7410_GPIOLines : public ADT7410_LineSource
+{
+public:
+	/* Request lines of a chip (e.g. "/dev/gpiochip0") */
+	ADT7410_GPIOLines(const char *chip, const uint32_t *lines, size_t count, bool pullUp = false);
+
+	~ADT7410_GPIOLines();
+
+	bool isOpen() const
+	{
+		return fd >= 0;
+	}
+
+	/* errno of the failed line request, 0 if open */
+	int error() const
+	{
+		return last_error;
+	}
+
+	int getFd() const
+	{
+		return fd;
+	}
+
+	size_t readEvents(ADT7410_LineEvent *events, size_t max);
+	int getLevel(uint32_t line);
+
+private:
+	ADT7410_GPIOLines(const ADT7410_GPIOLines &);
+	ADT7410_GPIOLines &operator=(const ADT7410_GPIOLines &);
+
+	int fd;  // line request descriptor
+	int last_error;
+	std::vector<uint32_t> offsets;  // index in the request -> offset
+};
+
+/*
+ * Lines driven by software, for tests and simulations: setLevel() queues an edge
+ * when the level changes and signals an eventfd. Thread-safe.
+ */
+class ADT7410_EventFdLines : public ADT7410_LineSource
+{
+public:
+	/* Lines 0 to count-1, all at level */
+	ADT7410_EventFdLines(uint32_t count, int level = 1);
+
+	~ADT7410_EventFdLines();
+
+	/* Drive a line, timestamp 0 means now */
+	void setLevel(uint32_t line, int level, uint64_t timestamp = 0);
+
+	int getFd() const
+	{
+		return fd;
+	}
+
+	size_t readEvents(ADT7410_LineEvent *events, size_t max);
+	int getLevel(uint32_t line);
+
+private:
+	ADT7410_EventFdLines(const ADT7410_EventFdLines &);
+	ADT7410_EventFdLines &operator=(const ADT7410_EventFdLines &);
+
+	int fd;
+	pthread_mutex_t lock;
+	std::vector<int> levels;
+	std::deque<ADT7410_LineEvent> pending;
+};
+
+/*
+ * Event-driven sampling: instead of polling Status on every device, wait for
+ * edges on the lines INT and CT are wired to and read only the devices on the
+ * line that moved. Each read is one snapshot block read (TEMPERATURE, Status
+ * and Configuration), delivered to the sink like ADT7410_Acquisition does.
+ *
+ * Several devices may share an open-drain line, provided their pins on it have
+ * the same polarity. attach() refuses the others; a Configuration that would
+ * flip a pin against the rest of its line, passed to setConfiguration() or
+ * seen in a snapshot, is counted in Stats::conflicts and its polarities are not
+ * taken over (setConfiguration() refuses it). An edge is interpreted per
+ * device using its pin polarity and INT_CT_MODE, taken from the Configuration
+ * byte of its last snapshot:
+ *  - interrupt mode (INT only): the assert edge is read; any register read
+ *    clears the pin, so the release edge that follows is our own and ignored.
+ *    If the line is still active after every device on it was read, another
+ *    device asserted meanwhile and the line is read again.
+ *  - comparator mode (INT, and CT always): the pin follows the condition, so
+ *    both edges are read, the release reporting the cleared flags. While such
+ *    a line is held active, a further device on it cannot produce an edge, so
+ *    its devices are re-read every hold period until the line releases.
+ *
+ * Not thread-safe: call wait() or process() from one thread. The event
+ * source's descriptor can be polled by the caller's own loop, see getFd().
+ */
+class ADT7410_AlarmEvents
+{
+public:
+	enum Pin
+	{
+		INT,
+		CT
+	};
+
+	struct Stats
+	{
+		uint64_t edges;
+		uint64_t ignored;  // release edges of interrupt-mode pins
+		uint64_t reads;    // snapshot reads issued
+		uint64_t errors;   // failed reads
+		uint64_t rereads;  // lines still active after their devices were read
+		uint64_t holds;    // reads of devices on held comparator lines
+		uint64_t conflicts;  // Configurations whose pin polarities clashed with a shared line
+	};
+
+	/* Returned by addDevice() on failure */
+	enum { INVALID_DEVICE = 0xFFFF };
+
+	ADT7410_AlarmEvents(ADT7410_LineSource &source, ADT7410_SampleSink &sink);
+
+	/* Add a device, its Configuration is read to learn polarities and mode; returns the id passed to the sink */
+	uint16_t addDevice(ADT7410_Base &device);
+
+	/* Declare a device pin wired to a line; false if its polarity differs from the pins already on the line */
+	bool attach(uint16_t device, Pin pin, uint32_t line);
+
+	/* Update the Configuration of a device after changing it elsewhere; false if its polarities conflict with a line */
+	bool setConfiguration(uint16_t device, uint8_t configuration);
+
+	/* Re-read interval of devices on held comparator lines (nanoseconds), default 1 s */
+	void setHoldPeriod(uint64_t period);
+
+	/* Read the devices of lines already active, e.g. after start-up; returns the number of reads */
+	int sync();
+
+	/* Wait up to timeout (nanoseconds, 0: do not block) for edges and handle them; returns the number of reads or -1 */
+	int wait(uint64_t timeout);
+
+	/* Handle pending edges and due hold re-reads without blocking */
+	int process();
+
+	int getFd() const
+	{
+		return source.getFd();
+	}
+
+	Stats getStats() const
+	{
+		return stats;
+	}
+
+private:
+	ADT7410_AlarmEvents(const ADT7410_AlarmEvents &);
+	ADT7410_AlarmEvents &operator=(const ADT7410_AlarmEvents &);
+
+	struct Device
+	{
+		ADT7410_Base *device;
+		uint8_t configuration;
+		bool pending;
+	};
+
+	struct Attachment
+	{
+		uint16_t device;
+		Pin pin;
+	};
+
+	struct Line
+	{
+		uint32_t id;
+		std::vector<Attachment> attached;
+		bool touched;  // had an edge in this round
+		bool held;
+		uint64_t next;  // next hold re-read
+	};
+
+	Line *find(uint32_t line);
+	static bool activeHigh(uint8_t configuration, Pin pin);
+	bool activeHigh(const Attachment &a) const;
+	bool conflicts(uint16_t device, uint8_t configuration) const;
+	bool comparator(const Attachment &a) const;
+	bool isActive(const Line &line);
+	size_t mark(const Line &line, bool comparators);
+	void edge(const ADT7410_LineEvent &event);
+	int readPending();
+	int settle(Line &line, uint64_t now);
+	int serviceHeld(uint64_t now);
+
+	ADT7410_LineSource &source;
+	ADT7410_SampleSink &sink;
+	std::vector<Device> devices;
+	std::vector<Line> lines;
+	uint64_t hold_period;
+	Stats stats;
+};
+
+#endif /* ADT7410_EVENTS_HPP */
@@ -0,0 +1,247 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Instrumented.cpp
+ */
+
+#include "ADT7410_Instrumented.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+const char *ADT7410_TransactionStats::name(int slot)
+{
+	static const char *const names[SLOTS] =
+	{
+		"TEMPERATURE", "TEMPERATURE+1", "Status", "Configuration",
+		"THIGH", "THIGH+1", "TLOW", "TLOW+1", "TCRIT", "TCRIT+1",
+		"THYST", "ID", "RESET", "other"
+	};
+	return slot >= 0 && slot < SLOTS ? names[slot] : "other";
+}
+
+static const char *const DIRECTION_NAMES[ADT7410_TransactionStats::DIRECTIONS] = { "read", "write" };
+
+static const char *const METRIC_NAMES[ADT7410_TransactionStats::METRICS][3] =
+{
+	{ "transactions_total", "Register transactions", "counter" },
+	{ "bytes_total", "Data bytes transferred", "counter" },
+	{ "errors_total", "Transactions that reported an error", "counter" },
+	{ "nacks_total", "Transactions that were not acknowledged", "counter" },
+	{ "transaction_duration_seconds", "Register transaction latency", "histogram" },
+	{ "transaction_duration_max_seconds", "Longest register transaction since the statistics were reset", "gauge" },
+};
+
+std::string ADT7410_TransactionStats::prometheusHeader(Metric metric, const char *prefix)
+{
+	char line[256];
+	snprintf(line, sizeof(line), "# HELP %s_%s %s\n# TYPE %s_%s %s\n",
+		prefix, METRIC_NAMES[metric][0], METRIC_NAMES[metric][1], prefix, METRIC_NAMES[metric][0], METRIC_NAMES[metric][2]);
+	return line;
+}
+
+std::string ADT7410_TransactionStats::prometheusSamples(Metric metric, const char *prefix, const char *labels) const
+{
+	const char *name = METRIC_NAMES[metric][0];
+	const char *extra = labels && *labels ? labels : 0;
+	std::string out;
+	char line[256];
+
+	for (int s = 0; s < SLOTS; s++)
+		for (int d = 0; d < DIRECTIONS; d++)
+		{
+			const Entry &e = entries[s][d];
+			if (!e.count)
+				continue;
+			char series[128];
+			snprintf(series, sizeof(series), "register=\"%s\",direction=\"%s\"%s%s",
+				this->name(s), DIRECTION_NAMES[d], extra ? "," : "", extra ? extra : "");
+
+			if (metric == DURATION_MAX)
+			{
+				snprintf(line, sizeof(line), "%s_%s{%s} %.9g\n", prefix, name, series, double(e.max) * 1e-9);
+				out += line;
+				continue;
+			}
+			if (metric != DURATION)
+			{
+				uint64_t value = metric == TRANSACTIONS ? e.count : metric == BYTES ? e.bytes : metric == ERRORS ? e.errors : e.nacks;
+				snprintf(line, sizeof(line), "%s_%s{%s} %llu\n", prefix, name, series, (unsigned long long)value);
+				out += line;
+				continue;
+			}
+
+			/* Every bound, cumulative; the last bucket has no finite bound and only counts towards +Inf */
+			uint64_t cumulative = 0;
+			for (int b = 0; b < BUCKETS - 1; b++)
+			{
+				cumulative += e.buckets[b];
+				snprintf(line, sizeof(line), "%s_%s_bucket{%s,le=\"%.9g\"} %llu\n",
+					prefix, name, series, double(uint64_t(2) << b) * 1e-9, (unsigned long long)cumulative);
+				out += line;
+			}
+			snprintf(line, sizeof(line), "%s_%s_bucket{%s,le=\"+Inf\"} %llu\n", prefix, name, series, (unsigned long long)e.count);
+			out += line;
+			snprintf(line, sizeof(line), "%s_%s_sum{%s} %.9g\n", prefix, name, series, double(e.total) * 1e-9);
+			out += line;
+			snprintf(line, sizeof(line), "%s_%s_count{%s} %llu\n", prefix, name, series, (unsigned long long)e.count);
+			out += line;
+		}
+	return out;
+}
+
+std::string ADT7410_TransactionStats::toPrometheus(const char *prefix, const char *labels) const
+{
+	return toPrometheus(this, &labels, 1, prefix);
+}
+
+std::string ADT7410_TransactionStats::toPrometheus(const ADT7410_TransactionStats *stats, const char *const *labels, size_t count,
+	const char *prefix)
+{
+	std::string out;
+	for (int m = 0; m < METRICS; m++)
+	{
+		out += prometheusHeader(Metric(m), prefix);
+		for (size_t i = 0; i < count; i++)
+			out += stats[i].prometheusSamples(Metric(m), prefix, labels ? labels[i] : 0);
+	}
+	return out;
+}
+
+
+ADT7410_Instrumented::ADT7410_Instrumented(ADT7410_Base &device, bool enabled)
+	: device(device), enabled(enabled)
+{
+	pthread_mutex_init(&lock, 0);
+	memset(&stats, 0, sizeof(stats));
+}
+
+ADT7410_Instrumented::~ADT7410_Instrumented()
+{
+	pthread_mutex_destroy(&lock);
+}
+
+ADT7410_TransactionStats ADT7410_Instrumented::getStats()
+{
+	pthread_mutex_lock(&lock);
+	ADT7410_TransactionStats copy = stats;
+	pthread_mutex_unlock(&lock);
+	return copy;
+}
+
+void ADT7410_Instrumented::resetStats()
+{
+	pthread_mutex_lock(&lock);
+	memset(&stats, 0, sizeof(stats));
+	pthread_mutex_unlock(&lock);
+}
+
+void ADT7410_Instrumented::record(uint16_t address, int direction, uint16_t bytes, uint64_t begin)
+{
+	uint64_t duration = ADT7410_now() - begin;
+	int error = device.error();
+	int bucket = 0;
+	while (bucket < ADT7410_TransactionStats::BUCKETS - 1 && (duration >> (bucket + 1)))
+		bucket++;
+
+	pthread_mutex_lock(&lock);
+	ADT7410_TransactionStats::Entry &e = stats.entries[ADT7410_TransactionStats::slot(address)][direction];
+	e.count++;
+	e.bytes += bytes;
+	if (error)
+	{
+		e.errors++;
+		if (error == ENXIO || error == EREMOTEIO)
+			e.nacks++;
+	}
+	e.total += duration;
+	if (duration > e.max)
+		e.max = duration;
+	e.buckets[bucket]++;
+	pthread_mutex_unlock(&lock);
+}
+
+#if ADT7410_INSTRUMENTATION
+
+uint8_t ADT7410_Instrumented::read8(uint16_t address, uint16_t n)
+{
+	if (!enabled)
+		return device.read8(address, n);
+	uint64_t begin = ADT7410_now();
+	uint8_t value = device.read8(address, n);
+	record(address, ADT7410_TransactionStats::READ, 1, begin);
+	return value;
+}
+
+void ADT7410_Instrumented::write(uint16_t address, uint8_t value, uint16_t n)
+{
+	if (!enabled)
+		return device.write(address, value, n);
+	uint64_t begin = ADT7410_now();
+	device.write(address, value, n);
+	record(address, ADT7410_TransactionStats::WRITE, n ? 1 : 0, begin);
+}
+
+uint16_t ADT7410_Instrumented::read16(uint16_t address, uint16_t n)
+{
+	if (!enabled)
+		return device.read16(address, n);
+	uint64_t begin = ADT7410_now();
+	uint16_t value = device.read16(address, n);
+	record(address, ADT7410_TransactionStats::READ, 2, begin);
+	return value;
+}
+
+void ADT7410_Instrumented::write(uint16_t address, uint16_t value, uint16_t n)
+{
+	if (!enabled)
+		return device.write(address, value, n);
+	uint64_t begin = ADT7410_now();
+	device.write(address, value, n);
+	record(address, ADT7410_TransactionStats::WRITE, 2, begin);
+}
+
+void ADT7410_Instrumented::readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+{
+	if (!enabled)
+		return device.readBlock(address, buffer, length);
+	uint64_t begin = ADT7410_now();
+	device.readBlock(address, buffer, length);
+	record(address, ADT7410_TransactionStats::READ, length, begin);
+}
+
+#else
+
+uint8_t ADT7410_Instrumented::read8(uint16_t address, uint16_t n)
+{
+	return device.read8(address, n);
+}
+
+void ADT7410_Instrumented::write(uint16_t address, uint8_t value, uint16_t n)
+{
+	device.write(address, value, n);
+}
+
+uint16_t ADT7410_Instrumented::read16(uint16_t address, uint16_t n)
+{
+	return device.read16(address, n);
+}
+
+void ADT7410_Instrumented::write(uint16_t address, uint16_t value, uint16_t n)
+{
+	device.write(address, value, n);
+}
+
+void ADT7410_Instrumented::readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+{
+	device.readBlock(address, buffer, length);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Instrumented.hpp
+ */
+
+#ifndef ADT7410_INSTRUMENTED_HPP
+#define ADT7410_INSTRUMENTED_HPP
+
+#include "ADT7410.hpp"
+
+#include <string>
+#include <pthread.h>
+
+/* Set to 0 to compile the instrumentation out, the wrapper then only forwards */
+#ifndef ADT7410_INSTRUMENTATION
+#define ADT7410_INSTRUMENTATION 1
+#endif
+
+/* Transaction statistics per register and direction */
+struct ADT7410_TransactionStats
+{
+	/* Register slots: addresses 0 to 11, RESET, anything else */
+	enum { RESET_SLOT = 12, OTHER_SLOT = 13, SLOTS = 14 };
+	enum { READ = 0, WRITE = 1, DIRECTIONS = 2 };
+
+	/* Bucket i counts durations in [2^i, 2^(i+1)) ns, the last one everything longer */
+	enum { BUCKETS = 32 };
+
+	struct Entry
+	{
+		uint64_t count;
+		uint64_t bytes;
+		uint64_t errors;  // transactions reporting an error()
+		uint64_t nacks;   // errors that were a NACK (ENXIO, EREMOTEIO)
+		uint64_t total;   // summed duration, ns
+		uint64_t max;     // longest duration, ns
+		uint64_t buckets[BUCKETS];
+	};
+
+	Entry entries[SLOTS][DIRECTIONS];
+
+	/* Slot of a register address */
+	static int slot(uint16_t address)
+	{
+		if (address <= ADT7410_Base::ID::__address)
+			return address;
+		return address == ADT7410_Base::RESET::__address ? RESET_SLOT : OTHER_SLOT;
+	}
+
+	/* Register name of a slot, "TEMPERATURE" for 0, "TEMPERATURE+1" for 1 and so on */
+	static const char *name(int slot);
+
+	/*
+	 * Exposed metrics, DURATION is a histogram with the le bounds 2^1 to 2^31 ns and +Inf,
+	 * DURATION_MAX a gauge of the longest transaction since the last reset
+	 */
+	enum Metric { TRANSACTIONS, BYTES, ERRORS, NACKS, DURATION, DURATION_MAX, METRICS };
+
+	/* HELP and TYPE lines of a metric, once per exposition */
+	static std::string prometheusHeader(Metric metric, const char *prefix = "adt7410");
+
+	/*
+	 * Samples of a metric, without header; labels (e.g. "device=\"3\"") are added to
+	 * every sample. Registers never accessed in a direction have no samples, all
+	 * others the full bucket set.
+	 */
+	std::string prometheusSamples(Metric metric, const char *prefix = "adt7410", const char *labels = 0) const;
+
+	/* Prometheus text exposition of one device */
+	std::string toPrometheus(const char *prefix = "adt7410", const char *labels = 0) const;
+
+	/* Prometheus text exposition of several devices, labels[i] belonging to stats[i], one header per metric */
+	static std::string toPrometheus(const ADT7410_TransactionStats *stats, const char *const *labels, size_t count,
+		const char *prefix = "adt7410");
+};
+
+/*
+ * Wraps another transport and records every read8/read16/write/readBlock:
+ * count, bytes, errors and NACKs and a log2 latency histogram per register and
+ * direction. Disabled at run time it costs one branch per transaction, with
+ * ADT7410_INSTRUMENTATION set to 0 it is compiled out entirely.
+ */
+class ADT7410_Instrumented : public ADT7410_Base
+{
+public:
+	ADT7410_Instrumented(ADT7410_Base &device, bool enabled = true);
+	~ADT7410_Instrumented();
+
+	void setEnabled(bool enabled)
+	{
+		this->enabled = enabled;
+	}
+
+	bool isEnabled() const
+	{
+		return enabled;
+	}
+
+	/* Consistent copy of the statistics, may be called from any thread */
+	ADT7410_TransactionStats getStats();
+
+	void resetStats();
+
+	int error()
+	{
+		return device.error();
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n=8);
+	void write(uint16_t address, uint8_t value, uint16_t n=8);
+	uint16_t read16(uint16_t address, uint16_t n=16);
+	void write(uint16_t address, uint16_t value, uint16_t n=16);
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length);
+
+private:
+	ADT7410_Instrumented(const ADT7410_Instrumented &);
+	ADT7410_Instrumented &operator=(const ADT7410_Instrumented &);
+
+	void record(uint16_t address, int direction, uint16_t bytes, uint64_t begin);
+
+	ADT7410_Base &device;
+	bool enabled;
+	pthread_mutex_t lock;
+	ADT7410_TransactionStats stats;
+};
+
+#endif /* ADT7410_INSTRUMENTED_HPP */
@@ -0,0 +1,218 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_LinuxI2C.cpp
+ */
+
+#include "ADT7410_LinuxI2C.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+ADT7410_LinuxI2C::ADT7410_LinuxI2C(const char *bus, uint8_t address)
+	: fd(-1), owned(true), smbus(false), smbus_block(false), address(address), last_error(0), transactions(0)
+{
+	fd = open(bus, O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+		last_error = errno;
+	else
+		probe();
+}
+
+ADT7410_LinuxI2C::ADT7410_LinuxI2C(int fd, uint8_t address)
+	: fd(fd), owned(false), smbus(false), smbus_block(false), address(address), last_error(0), transactions(0)
+{
+	if (fd >= 0)
+		probe();
+}
+
+void ADT7410_LinuxI2C::probe()
+{
+	unsigned long funcs = 0;
+	if (ioctl(fd, I2C_FUNCS, &funcs) < 0 || (funcs & I2C_FUNC_I2C))
+		return;
+	smbus = true;
+	smbus_block = (funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK) != 0;
+
+	/* An owned descriptor talks to this device only */
+	if (owned && ioctl(fd, I2C_SLAVE, (unsigned long)address) < 0)
+		last_error = errno;
+}
+
+ADT7410_LinuxI2C::~ADT7410_LinuxI2C()
+{
+	if (owned && fd >= 0)
+		close(fd);
+}
+
+bool ADT7410_LinuxI2C::transfer(const uint8_t *out, uint16_t out_length, uint8_t *in, uint16_t in_length)
+{
+	struct i2c_msg messages[2];
+	struct i2c_rdwr_ioctl_data data;
+
+	messages[0].addr = address;
+	messages[0].flags = 0;
+	messages[0].len = out_length;
+	messages[0].buf = const_cast<uint8_t *>(out);
+	messages[1].addr = address;
+	messages[1].flags = I2C_M_RD;
+	messages[1].len = in_length;
+	messages[1].buf = in;
+	data.msgs = messages;
+	data.nmsgs = in_length ? 2 : 1;
+
+	transactions++;
+	if (ioctl(fd, I2C_RDWR, &data) < 0)
+	{
+		last_error = errno;
+		if (in_length)
+			memset(in, 0, in_length);
+		return false;
+	}
+	last_error = 0;
+	return true;
+}
+
+bool ADT7410_LinuxI2C::smbusTransfer(uint8_t read_write, uint8_t command, uint32_t size, void *data)
+{
+	if (!owned && ioctl(fd, I2C_SLAVE, (unsigned long)address) < 0)
+	{
+		last_error = errno;
+		return false;
+	}
+
+	struct i2c_smbus_ioctl_data args;
+	args.read_write = read_write;
+	args.command = command;
+	args.size = size;
+	args.data = static_cast<union i2c_smbus_data *>(data);
+
+	transactions++;
+	if (ioctl(fd, I2C_SMBUS, &args) < 0)
+	{
+		last_error = errno;
+		return false;
+	}
+	last_error = 0;
+	return true;
+}
+
+uint8_t ADT7410_LinuxI2C::read8(uint16_t address, uint16_t)
+{
+	if (smbus)
+	{
+		union i2c_smbus_data data;
+		return smbusTransfer(I2C_SMBUS_READ, uint8_t(address), I2C_SMBUS_BYTE_DATA, &data) ? data.byte : 0;
+	}
+	uint8_t pointer = uint8_t(address);
+	uint8_t value = 0;
+	transfer(&pointer, 1, &value, 1);
+	return value;
+}
+
+void ADT7410_LinuxI2C::write(uint16_t address, uint8_t value, uint16_t n)
+{
+	/* n == 0 is a bare pointer write, i.e. a command such as RESET */
+	if (smbus)
+	{
+		union i2c_smbus_data data;
+		data.byte = value;
+		if (n)
+			smbusTransfer(I2C_SMBUS_WRITE, uint8_t(address), I2C_SMBUS_BYTE_DATA, &data);
+		else
+			smbusTransfer(I2C_SMBUS_WRITE, uint8_t(address), I2C_SMBUS_BYTE, 0);
+		return;
+	}
+	uint8_t buffer[2] = { uint8_t(address), value };
+	transfer(buffer, n ? 2 : 1, 0, 0);
+}
+
+uint16_t ADT7410_LinuxI2C::read16(uint16_t address, uint16_t)
+{
+	if (smbus)
+	{
+		union i2c_smbus_data data;
+		if (!smbusTransfer(I2C_SMBUS_READ, uint8_t(address), I2C_SMBUS_WORD_DATA, &data))
+			return 0;
+		return uint16_t((data.word << 8) | (data.word >> 8));
+	}
+	uint8_t pointer = uint8_t(address);
+	uint8_t value[2] = { 0, 0 };
+	transfer(&pointer, 1, value, 2);
+	return uint16_t((value[0] << 8) | value[1]);
+}
+
+void ADT7410_LinuxI2C::write(uint16_t address, uint16_t value, uint16_t)
+{
+	if (smbus)
+	{
+		union i2c_smbus_data data;
+		data.word = uint16_t((value << 8) | (value >> 8));
+		smbusTransfer(I2C_SMBUS_WRITE, uint8_t(address), I2C_SMBUS_WORD_DATA, &data);
+		return;
+	}
+	uint8_t buffer[3] = { uint8_t(address), uint8_t(value >> 8), uint8_t(value) };
+	transfer(buffer, 3, 0, 0);
+}
+
+void ADT7410_LinuxI2C::readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+{
+	if (smbus && !smbus_block)
+	{
+		/* One byte or word transfer per register; stop at the first failure so error() reports it */
+		uint16_t i = 0;
+		bool ok = true;
+		while (i < length && ok)
+		{
+			uint16_t a = uint16_t(address + i);
+			if (length - i >= 2 && (a == 0 || a == 4 || a == 6 || a == 8))
+			{
+				uint16_t value = read16(a);
+				buffer[i++] = uint8_t(value >> 8);
+				buffer[i++] = uint8_t(value);
+			}
+			else
+				buffer[i++] = read8(a);
+			ok = !last_error;
+		}
+		if (!ok)
+			memset(buffer, 0, length);
+		return;
+	}
+	while (length)
+	{
+		uint16_t chunk = length < uint16_t(MAX_BLOCK) ? length : uint16_t(MAX_BLOCK);
+		bool ok;
+		if (smbus)
+		{
+			union i2c_smbus_data data;
+			data.block[0] = uint8_t(chunk);
+			ok = smbusTransfer(I2C_SMBUS_READ, uint8_t(address), I2C_SMBUS_I2C_BLOCK_DATA, &data);
+			if (ok)
+				memcpy(buffer, data.block + 1, chunk);
+		}
+		else
+		{
+			uint8_t pointer = uint8_t(address);
+			ok = transfer(&pointer, 1, buffer, chunk);
+		}
+		if (!ok)
+		{
+			memset(buffer, 0, length);
+			return;
+		}
+		address += chunk;
+		buffer += chunk;
+		length -= chunk;
+	}
+}
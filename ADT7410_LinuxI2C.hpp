@@ -0,0 +1,111 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_LinuxI2C.hpp
+ */
+
+#ifndef ADT7410_LINUXI2C_HPP
+#define ADT7410_LINUXI2C_HPP
+
+#include "ADT7410.hpp"
+
+/*
+ * ADT7410 on a Linux i2c-dev bus (/dev/i2c-N).
+ * Every register access is a single I2C_RDWR ioctl: reads are a pointer write
+ * followed by a repeated start and the data read, writes are one message.
+ * The slave address travels in the messages, so I2C_SLAVE is never issued and
+ * several devices can share one open bus file descriptor.
+ *
+ * Adapters without plain I2C transfers (I2C_FUNC_I2C missing from I2C_FUNCS,
+ * e.g. SMBus-only controllers and i2c-stub) are driven with I2C_SMBUS ioctls
+ * instead: byte data, word data (byte-swapped, SMBus words are LSB first) and
+ * I2C block data for readBlock() where the adapter supports it. The slave
+ * address is then set with I2C_SLAVE, once for an owned descriptor and before
+ * every transfer on a shared one.
+ *
+ * Local testing without hardware (i2c-stub is a plain register file, it has
+ * none of the ADT7410's behaviour, but exercises the whole transport):
+ *   modprobe i2c-stub chip_addr=0x48
+ *   ADT7410_LinuxI2C sensor("/dev/i2c-<stub bus>", 0x48);  // isSMBus() is true
+ */
+class ADT7410_LinuxI2C : public ADT7410_Base
+{
+public:
+	/* Longest block read issued in one transaction (the whole register map fits) */
+	enum { MAX_BLOCK = 32 };
+
+	/* Open bus device (e.g. "/dev/i2c-1"), the descriptor is owned and closed on destruction */
+	ADT7410_LinuxI2C(const char *bus, uint8_t address = 0x48);
+
+	/* Use an already open bus descriptor, e.g. shared between devices on the same bus */
+	ADT7410_LinuxI2C(int fd, uint8_t address);
+
+	~ADT7410_LinuxI2C();
+
+	bool isOpen() const
+	{
+		return fd >= 0;
+	}
+
+	int getFd() const
+	{
+		return fd;
+	}
+
+	uint8_t getAddress() const
+	{
+		return address;
+	}
+
+	/* Whether the adapter is driven with SMBus transfers */
+	bool isSMBus() const
+	{
+		return smbus;
+	}
+
+	/* Number of transfer ioctls issued, I2C_RDWR or I2C_SMBUS (one per register access or block read) */
+	uint32_t getTransactions() const
+	{
+		return transactions;
+	}
+
+	/* errno of the last transaction, 0 if it succeeded */
+	int error()
+	{
+		return last_error;
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n=8);
+	void write(uint16_t address, uint8_t value, uint16_t n=8);
+	uint16_t read16(uint16_t address, uint16_t n=16);
+	void write(uint16_t address, uint16_t value, uint16_t n=16);
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length);
+
+private:
+	ADT7410_LinuxI2C(const ADT7410_LinuxI2C &);
+	ADT7410_LinuxI2C &operator=(const ADT7410_LinuxI2C &);
+
+	/* Query I2C_FUNCS and select the transfer type */
+	void probe();
+
+	/* Write pointer (and data), optionally followed by a repeated start read */
+	bool transfer(const uint8_t *out, uint16_t out_length, uint8_t *in, uint16_t in_length);
+
+	/* One I2C_SMBUS transfer of the given size (I2C_SMBUS_BYTE_DATA, ...) */
+	bool smbusTransfer(uint8_t read_write, uint8_t command, uint32_t size, void *data);
+
+	int fd;
+	bool owned;
+	bool smbus;
+	bool smbus_block;  // I2C block reads supported
+	uint8_t address;
+	int last_error;
+	uint32_t transactions;
+};
+
+#endif /* ADT7410_LINUXI2C_HPP */
@@ -0,0 +1,493 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Log.cpp
+ */
+
+#include "ADT7410_Log.hpp"
+
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char FILE_MAGIC[8] = { 'A', 'D', 'T', '7', '4', '1', '0', 'L' };
+static const uint32_t FILE_VERSION = 2;
+static const size_t FILE_HEADER = 16;
+static const uint32_t CHUNK_MAGIC = 0x4B4E4843;  // "CHNK"
+static const size_t CHUNK_HEADER = 40;
+static const size_t CHUNK_HEADER_V1 = 32;
+
+enum
+{
+	TAG_SAMPLE = 0,
+	TAG_STATE = 1
+};
+
+typedef ADT7410_Base::Configuration::RESOLUTION RESOLUTION;
+
+static void put32(uint8_t *p, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		p[i] = uint8_t(value >> (8 * i));
+}
+
+static void put64(uint8_t *p, uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+		p[i] = uint8_t(value >> (8 * i));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	uint32_t value = 0;
+	for (int i = 3; i >= 0; i--)
+		value = (value << 8) | p[i];
+	return value;
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+	uint64_t value = 0;
+	for (int i = 7; i >= 0; i--)
+		value = (value << 8) | p[i];
+	return value;
+}
+
+/* CLOCK_REALTIME - CLOCK_MONOTONIC, nanoseconds */
+static int64_t epoch()
+{
+	struct timespec real, monotonic;
+	clock_gettime(CLOCK_REALTIME, &real);
+	clock_gettime(CLOCK_MONOTONIC, &monotonic);
+	return (int64_t(real.tv_sec) - int64_t(monotonic.tv_sec)) * 1000000000 + (real.tv_nsec - monotonic.tv_nsec);
+}
+
+static void putVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(uint8_t(value));
+}
+
+/* Returns false on a truncated varint */
+static bool getVarint(const uint8_t *data, size_t &position, size_t end, uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (position >= end)
+			return false;
+		uint8_t byte = data[position++];
+		value |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+
+ADT7410_LogWriter::ADT7410_LogWriter()
+	: file(0), chunk_size(0), records(0), first(0), last(0), end(0), bytes_written(0)
+{
+}
+
+ADT7410_LogWriter::~ADT7410_LogWriter()
+{
+	close();
+}
+
+bool ADT7410_LogWriter::open(const char *path, size_t chunk_size)
+{
+	close();
+	file = fopen(path, "a+b");
+	if (!file)
+		return false;
+	this->chunk_size = chunk_size;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	uint8_t header[FILE_HEADER];
+
+	/* A file shorter than its header never held a chunk */
+	if (size > 0 && size < long(FILE_HEADER) && ftruncate(fileno(file), 0) == 0)
+		size = 0;
+	if (size == 0)
+	{
+		memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+		put32(header + 8, FILE_VERSION);
+		put32(header + 12, 0);
+		if (fwrite(header, sizeof(header), 1, file) != 1 || fflush(file) != 0)
+		{
+			close();
+			return false;
+		}
+		end = sizeof(header);
+		bytes_written = sizeof(header);
+		return true;
+	}
+
+	fseek(file, 0, SEEK_SET);
+	if (fread(header, sizeof(header), 1, file) != 1 || memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+		|| get32(header + 8) != FILE_VERSION)
+	{
+		close();
+		return false;
+	}
+
+	/* Hop over the complete chunks like the reader does, and cut off a torn one */
+	end = FILE_HEADER;
+	uint8_t chunk[CHUNK_HEADER];
+	while (end + CHUNK_HEADER <= uint64_t(size))
+	{
+		fseek(file, long(end), SEEK_SET);
+		if (fread(chunk, sizeof(chunk), 1, file) != 1 || get32(chunk) != CHUNK_MAGIC)
+			break;
+		uint64_t next = end + CHUNK_HEADER + get32(chunk + 4);
+		if (next > uint64_t(size))
+			break;
+		end = next;
+	}
+	if (end < uint64_t(size) && ftruncate(fileno(file), off_t(end)) != 0)
+	{
+		close();
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	return true;
+}
+
+void ADT7410_LogWriter::close()
+{
+	if (!file)
+		return;
+	flush();
+	fclose(file);
+	file = 0;
+}
+
+bool ADT7410_LogWriter::append(const ADT7410_Sample &sample)
+{
+	if (!file)
+		return false;
+	if (sample.device >= devices.size())
+	{
+		DeviceState unseen = { 0, 0, 0, false };
+		devices.resize(sample.device + 1, unseen);
+	}
+	DeviceState &state = devices[sample.device];
+	uint8_t resolution = uint8_t(ADT7410_Base::get<RESOLUTION>(sample.configuration));
+
+	if (!records)
+		first = last = sample.timestamp;
+
+	if (!state.seen || state.status != sample.status || state.resolution != resolution)
+	{
+		payload.push_back(TAG_STATE);
+		putVarint(payload, sample.device);
+		payload.push_back(sample.status);
+		payload.push_back(resolution);
+		records++;
+		state.status = sample.status;
+		state.resolution = resolution;
+		if (!state.seen)
+		{
+			state.temperature = 0;
+			state.seen = true;
+		}
+	}
+
+	payload.push_back(TAG_SAMPLE);
+	putVarint(payload, sample.device);
+	putVarint(payload, zigzag(int64_t(sample.timestamp - last)));
+	putVarint(payload, zigzag(int16_t(uint16_t(sample.temperature - state.temperature))));
+	records++;
+	state.temperature = sample.temperature;
+	last = sample.timestamp;
+
+	if (payload.size() >= chunk_size)
+		return flush();
+	return true;
+}
+
+bool ADT7410_LogWriter::append(const ADT7410_Sample *samples, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		if (!append(samples[i]))
+			return false;
+	return true;
+}
+
+bool ADT7410_LogWriter::flush()
+{
+	if (!file)
+		return false;
+	if (!records)
+		return true;
+
+	uint8_t header[CHUNK_HEADER];
+	put32(header, CHUNK_MAGIC);
+	put32(header + 4, uint32_t(payload.size()));
+	put32(header + 8, records);
+	put32(header + 12, 0);
+	put64(header + 16, first);
+	put64(header + 24, last);
+	put64(header + 32, uint64_t(epoch()));
+	bool ok = fwrite(header, sizeof(header), 1, file) == 1
+		&& fwrite(&payload[0], payload.size(), 1, file) == 1
+		&& fflush(file) == 0;
+	if (!ok)
+	{
+		/* Drop whatever part made it to the file; the chunk stays pending and is retried */
+		clearerr(file);
+		if (ftruncate(fileno(file), off_t(end)) != 0)
+			return false;
+		fseek(file, 0, SEEK_END);
+		return false;
+	}
+	end += sizeof(header) + payload.size();
+	bytes_written += sizeof(header) + payload.size();
+
+	/* The next chunk starts from scratch */
+	payload.clear();
+	records = 0;
+	for (size_t i = 0; i < devices.size(); i++)
+		devices[i].seen = false;
+	return true;
+}
+
+
+ADT7410_LogReader::ADT7410_LogReader()
+	: data(0), size(0), begin(0), end(0), chunk(0), position(0), remaining(0), time(0), pending(false)
+{
+}
+
+ADT7410_LogReader::~ADT7410_LogReader()
+{
+	close();
+}
+
+bool ADT7410_LogReader::open(const char *path)
+{
+	close();
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || size_t(st.st_size) < FILE_HEADER)
+	{
+		::close(fd);
+		return false;
+	}
+	void *map = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+		return false;
+	data = static_cast<const uint8_t *>(map);
+	size = size_t(st.st_size);
+
+	uint32_t version = get32(data + 8);
+	if (memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || version < 1 || version > FILE_VERSION)
+	{
+		close();
+		return false;
+	}
+	const size_t chunk_header = version == 1 ? CHUNK_HEADER_V1 : CHUNK_HEADER;
+
+	/* Hop from chunk header to chunk header, payloads are not touched */
+	size_t offset = FILE_HEADER;
+	while (offset + chunk_header <= size && get32(data + offset) == CHUNK_MAGIC)
+	{
+		Chunk c;
+		c.offset = offset + chunk_header;
+		c.bytes = get32(data + offset + 4);
+		c.records = get32(data + offset + 8);
+		c.epoch = version == 1 ? 0 : int64_t(get64(data + offset + 32));
+		c.first = get64(data + offset + 16) + uint64_t(c.epoch);
+		c.last = get64(data + offset + 24) + uint64_t(c.epoch);
+		if (c.offset + c.bytes > size)
+			break;
+		chunks.push_back(c);
+		offset = c.offset + c.bytes;
+	}
+	seek(0);
+	return true;
+}
+
+void ADT7410_LogReader::close()
+{
+	if (data)
+		munmap(const_cast<uint8_t *>(data), size);
+	data = 0;
+	size = 0;
+	chunks.clear();
+	devices.clear();
+}
+
+void ADT7410_LogReader::enterChunk(size_t c)
+{
+	chunk = c;
+	devices.clear();
+	if (chunk < chunks.size())
+	{
+		position = chunks[chunk].offset;
+		remaining = chunks[chunk].records;
+		time = chunks[chunk].first;
+	}
+	else
+		remaining = 0;
+}
+
+void ADT7410_LogReader::seek(uint64_t begin, uint64_t end)
+{
+	this->begin = begin;
+	this->end = end;
+	pending = false;
+
+	/* First chunk that may contain begin */
+	size_t low = 0, high = chunks.size();
+	while (low < high)
+	{
+		size_t middle = (low + high) / 2;
+		if (chunks[middle].last < begin)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	enterChunk(low);
+}
+
+bool ADT7410_LogReader::next(ADT7410_Sample &sample)
+{
+	while (chunk < chunks.size())
+	{
+		if (!remaining)
+		{
+			if (chunk + 1 >= chunks.size() || chunks[chunk + 1].first >= end)
+				break;
+			enterChunk(chunk + 1);
+			continue;
+		}
+		remaining--;
+
+		const size_t limit = chunks[chunk].offset + chunks[chunk].bytes;
+		uint64_t device = 0, a = 0, b = 0;
+		if (position >= limit)
+		{
+			remaining = 0;
+			continue;
+		}
+		uint8_t tag = data[position++];
+		bool ok = getVarint(data, position, limit, device) && device <= 0xFFFF;
+		if (ok && tag == TAG_STATE)
+			ok = position + 2 <= limit;
+		else if (ok && tag == TAG_SAMPLE)
+			ok = getVarint(data, position, limit, a) && getVarint(data, position, limit, b);
+		else
+			ok = false;
+		if (!ok)
+		{
+			/* Malformed chunk, skip the rest of it */
+			remaining = 0;
+			continue;
+		}
+
+		if (device >= devices.size())
+		{
+			DeviceState unknown = { 0, 0, 0 };
+			devices.resize(size_t(device) + 1, unknown);
+		}
+		DeviceState &state = devices[size_t(device)];
+
+		if (tag == TAG_STATE)
+		{
+			state.status = data[position];
+			state.resolution = data[position + 1];
+			position += 2;
+			continue;
+		}
+
+		time += uint64_t(unzigzag(a));
+		state.temperature = uint16_t(state.temperature + uint16_t(unzigzag(b)));
+		if (time < begin)
+			continue;
+		if (time >= end)
+			break;
+		sample.timestamp = time;
+		sample.device = uint16_t(device);
+		sample.temperature = state.temperature;
+		sample.status = state.status;
+		sample.configuration = uint8_t(ADT7410_Base::set<RESOLUTION>(0, state.resolution));
+		return true;
+	}
+	chunk = chunks.size();
+	remaining = 0;
+	return false;
+}
+
+size_t ADT7410_LogReader::read(ADT7410_Sample *samples, size_t max)
+{
+	size_t n = 0;
+	if (pending && max)
+	{
+		samples[n++] = held;
+		pending = false;
+	}
+	while (n < max && next(samples[n]))
+		n++;
+	return n;
+}
+
+size_t ADT7410_LogReader::readRaw(uint16_t *raw, uint16_t *device, uint64_t *timestamp, size_t max, bool &res16)
+{
+	size_t n = 0;
+	ADT7410_Sample sample;
+	while (n < max)
+	{
+		if (pending)
+		{
+			sample = held;
+			pending = false;
+		}
+		else if (!next(sample))
+			break;
+
+		bool resolution = ADT7410_Base::get<RESOLUTION>(sample.configuration) == RESOLUTION::RES_16_BIT;
+		if (n == 0)
+			res16 = resolution;
+		else if (resolution != res16)
+		{
+			/* Keep the batch homogeneous, the sample starts the next one */
+			held = sample;
+			pending = true;
+			break;
+		}
+		raw[n] = sample.temperature;
+		if (device)
+			device[n] = sample.device;
+		if (timestamp)
+			timestamp[n] = sample.timestamp;
+		n++;
+	}
+	return n;
+}
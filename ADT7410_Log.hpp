@@ -0,0 +1,178 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Log.hpp
+ */
+
+#ifndef ADT7410_LOG_HPP
+#define ADT7410_LOG_HPP
+
+#include "ADT7410_Ring.hpp"
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Append-only binary log of raw samples.
+ *
+ * File:    header (16 bytes): "ADT7410L", uint32 version, uint32 reserved
+ *          followed by chunks.
+ * Chunk:   header (40 bytes): uint32 "CHNK", uint32 payload bytes, uint32 records,
+ *          uint32 reserved, uint64 first timestamp, uint64 last timestamp,
+ *          int64 epoch, followed by the payload.
+ * Payload: records, each a tag byte followed by varints:
+ *          SAMPLE: device, zigzag timestamp delta, zigzag TEMPERATURE delta
+ *          STATE:  device, Status byte, Configuration::RESOLUTION
+ *
+ * All integers are little endian. The timestamp delta is relative to the previous
+ * record of the chunk (the first to the chunk's first timestamp), the TEMPERATURE
+ * delta relative to the previous raw word of the same device. STATE records are
+ * only written when a device's Status byte or resolution changes. Delta state is
+ * reset for every chunk, so each chunk decodes on its own and a reader can jump
+ * from chunk header to chunk header to find a time range.
+ *
+ * Sample timestamps are CLOCK_MONOTONIC (ADT7410_now()), which restarts at boot.
+ * The epoch of a chunk is CLOCK_REALTIME - CLOCK_MONOTONIC when it was written,
+ * so the reader can place chunks of different boots on one wall-clock axis: it
+ * returns and seeks by wall-clock time (CLOCK_REALTIME nanoseconds).
+ *
+ * Version 1 files (32-byte chunk headers, no epoch) are still read, with
+ * timestamps as stored; the writer only appends to version 2 files.
+ */
+
+/* Writes a log, appending to an existing file */
+class ADT7410_LogWriter
+{
+public:
+	ADT7410_LogWriter();
+	~ADT7410_LogWriter();
+
+	/*
+	 * Open (or create) a log file for appending, chunk_size is the payload size that ends a chunk.
+	 * A chunk torn by a crash at the end of the file is cut off, so new chunks stay readable.
+	 */
+	bool open(const char *path, size_t chunk_size = 65536);
+
+	/* Write the pending chunk and close the file */
+	void close();
+
+	bool isOpen() const
+	{
+		return file != 0;
+	}
+
+	/* Append one sample */
+	bool append(const ADT7410_Sample &sample);
+
+	/* Append n samples */
+	bool append(const ADT7410_Sample *samples, size_t n);
+
+	/* Write the pending chunk to the file; on failure the file is cut back and the chunk kept for the next flush */
+	bool flush();
+
+	/* Encoded bytes written so far, excluding the pending chunk */
+	uint64_t getBytesWritten() const
+	{
+		return bytes_written;
+	}
+
+private:
+	ADT7410_LogWriter(const ADT7410_LogWriter &);
+	ADT7410_LogWriter &operator=(const ADT7410_LogWriter &);
+
+	struct DeviceState
+	{
+		uint16_t temperature;
+		uint8_t status;
+		uint8_t resolution;
+		bool seen;
+	};
+
+	FILE *file;
+	size_t chunk_size;
+	std::vector<uint8_t> payload;
+	std::vector<DeviceState> devices;
+	uint32_t records;
+	uint64_t first;
+	uint64_t last;
+	uint64_t end;  // file size up to the last complete chunk
+	uint64_t bytes_written;
+};
+
+/* Reads a log through a read-only memory mapping */
+class ADT7410_LogReader
+{
+public:
+	struct Chunk
+	{
+		size_t offset;  // offset of the payload in the file
+		uint32_t bytes;
+		uint32_t records;
+		uint64_t first;  // wall-clock
+		uint64_t last;
+		int64_t epoch;   // added to the stored timestamps
+	};
+
+	ADT7410_LogReader();
+	~ADT7410_LogReader();
+
+	/* Map a log file and index its chunks; a truncated last chunk is ignored */
+	bool open(const char *path);
+	void close();
+
+	const std::vector<Chunk> &getChunks() const
+	{
+		return chunks;
+	}
+
+	/* Restrict reading to samples with begin <= timestamp < end, positioned at begin */
+	void seek(uint64_t begin, uint64_t end = ~uint64_t(0));
+
+	/*
+	 * Read up to max samples. Status and Configuration are reconstructed from the
+	 * STATE records; Configuration only carries the RESOLUTION bit.
+	 */
+	size_t read(ADT7410_Sample *samples, size_t max);
+
+	/*
+	 * Read up to max raw TEMPERATURE words that share one resolution, ready for
+	 * ADT7410_decode(raw, out, n, res16). device and timestamp may be null.
+	 */
+	size_t readRaw(uint16_t *raw, uint16_t *device, uint64_t *timestamp, size_t max, bool &res16);
+
+private:
+	ADT7410_LogReader(const ADT7410_LogReader &);
+	ADT7410_LogReader &operator=(const ADT7410_LogReader &);
+
+	struct DeviceState
+	{
+		uint16_t temperature;
+		uint8_t status;
+		uint8_t resolution;
+	};
+
+	/* Decode the next sample of the range, false at its end */
+	bool next(ADT7410_Sample &sample);
+	void enterChunk(size_t chunk);
+
+	const uint8_t *data;
+	size_t size;
+	std::vector<Chunk> chunks;
+	std::vector<DeviceState> devices;
+	uint64_t begin;
+	uint64_t end;
+	size_t chunk;       // current chunk
+	size_t position;    // offset of the next record in the file
+	uint32_t remaining; // records left in the current chunk
+	uint64_t time;      // timestamp of the previous record
+	bool pending;       // sample held back by readRaw at a resolution change
+	ADT7410_Sample held;
+};
+
+#endif /* ADT7410_LOG_HPP */
@@ -0,0 +1,153 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Profile.cpp
+ */
+
+#include "ADT7410_Profile.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+/* The writable registers are contiguous: Configuration at 3 up to THYST at 10 */
+static const uint16_t FIRST = B::Configuration::__address;
+static const uint16_t LENGTH = B::THYST::__address - B::Configuration::__address + 1;
+
+ADT7410_Profile ADT7410_Profile::defaults()
+{
+	ADT7410_Profile p;
+	p.configuration = uint8_t(B::modify<C::FAULT_QUEUE>(C::FAULT_QUEUE::dflt)
+		.set<C::CT_PIN_POLARITY>(C::CT_PIN_POLARITY::dflt)
+		.set<C::INT_PIN_POLARITY>(C::INT_PIN_POLARITY::dflt)
+		.set<C::INT_CT_MODE>(C::INT_CT_MODE::dflt)
+		.set<C::OPMODE>(C::OPMODE::dflt)
+		.set<C::RESOLUTION>(C::RESOLUTION::dflt)
+		.apply(0));
+	p.thigh = B::THIGH::THIGH_::dflt;
+	p.tlow = B::TLOW::TLOW_::dflt;
+	p.tcrit = B::TCRIT::TCRIT_::dflt;
+	p.thyst = uint8_t(B::modify<B::THYST::HYSTERESIS>(B::THYST::HYSTERESIS::dflt)
+		.set<B::THYST::unused_0>(B::THYST::unused_0::dflt)
+		.apply(0));
+	return p;
+}
+
+uint8_t ADT7410_Profile::diff(const ADT7410_Profile &other) const
+{
+	return uint8_t((configuration != other.configuration ? CONFIGURATION : 0)
+		| (thigh != other.thigh ? THIGH : 0)
+		| (tlow != other.tlow ? TLOW : 0)
+		| (tcrit != other.tcrit ? TCRIT : 0)
+		| (thyst != other.thyst ? THYST : 0));
+}
+
+void ADT7410_Profile::unpack(const uint8_t *buffer)
+{
+	configuration = buffer[B::Configuration::__address - FIRST];
+	thigh = uint16_t((buffer[B::THIGH::__address - FIRST] << 8) | buffer[B::THIGH::__address - FIRST + 1]);
+	tlow = uint16_t((buffer[B::TLOW::__address - FIRST] << 8) | buffer[B::TLOW::__address - FIRST + 1]);
+	tcrit = uint16_t((buffer[B::TCRIT::__address - FIRST] << 8) | buffer[B::TCRIT::__address - FIRST + 1]);
+	thyst = buffer[B::THYST::__address - FIRST];
+}
+
+ADT7410_Profile::Result ADT7410_Profile::snapshot(ADT7410_Base &device)
+{
+	uint8_t buffer[LENGTH];
+	device.readBlock(FIRST, buffer, LENGTH);
+	if (device.error())
+		return BUS_ERROR;
+	unpack(buffer);
+	return OK;
+}
+
+ADT7410_Profile::Result ADT7410_Profile::apply(ADT7410_Base &device, bool verify, uint8_t *written) const
+{
+	ADT7410_Profile current;
+	if (written)
+		*written = 0;
+	if (current.snapshot(device) != OK)
+		return BUS_ERROR;
+	return apply(device, current, verify, written);
+}
+
+ADT7410_Profile::Result ADT7410_Profile::apply(ADT7410_Base &device, const ADT7410_Profile &current, bool verify, uint8_t *written) const
+{
+	uint8_t registers = diff(current);
+	if (B::get<C::OPMODE>(configuration) == C::OPMODE::ONE_SHOT)
+		registers |= CONFIGURATION;
+	if (written)
+		*written = 0;
+
+	/* Setpoints first, Configuration last */
+	if (registers & THYST)
+	{
+		device.setTHYST(thyst);
+		if (device.error())
+			return BUS_ERROR;
+	}
+	if (registers & TCRIT)
+	{
+		device.setTCRIT(tcrit);
+		if (device.error())
+			return BUS_ERROR;
+	}
+	if (registers & TLOW)
+	{
+		device.setTLOW(tlow);
+		if (device.error())
+			return BUS_ERROR;
+	}
+	if (registers & THIGH)
+	{
+		device.setTHIGH(thigh);
+		if (device.error())
+			return BUS_ERROR;
+	}
+	if (registers & CONFIGURATION)
+	{
+		device.setConfiguration(configuration);
+		if (device.error())
+			return BUS_ERROR;
+	}
+	if (written)
+		*written = registers;
+
+	return verify && registers ? this->verify(device, registers) : OK;
+}
+
+ADT7410_Profile::Result ADT7410_Profile::verify(ADT7410_Base &device, uint8_t registers) const
+{
+	ADT7410_Profile actual;
+	if (actual.snapshot(device) != OK)
+		return BUS_ERROR;
+	uint8_t differing = uint8_t(diff(actual) & registers);
+	if ((differing & CONFIGURATION) && B::get<C::OPMODE>(configuration) == C::OPMODE::ONE_SHOT)
+	{
+		/* Still converting, or back in shutdown already */
+		const uint16_t others = uint16_t(~C::OPMODE::mask & 0xFF);
+		uint16_t mode = B::get<C::OPMODE>(actual.configuration);
+		if (!((configuration ^ actual.configuration) & others) && (mode == C::OPMODE::ONE_SHOT || mode == C::OPMODE::SHUTDOWB))
+			differing &= uint8_t(~CONFIGURATION);
+	}
+	return differing ? VERIFY_FAILED : OK;
+}
+
+ADT7410_Profile::Result ADT7410_Profile::restore(ADT7410_Base &device, bool verify, uint8_t *written,
+	ADT7410_SleepHook sleep, void *context) const
+{
+	if (written)
+		*written = 0;
+	device.setRESET();
+	if (device.error())
+		return BUS_ERROR;
+	if (sleep)
+		sleep(B::RESET_TIME, context);
+	else
+		ADT7410_sleep(B::RESET_TIME);
+	return applyAfterReset(device, verify, written);
+}
@@ -0,0 +1,107 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Profile.hpp
+ */
+
+#ifndef ADT7410_PROFILE_HPP
+#define ADT7410_PROFILE_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Time.hpp"
+
+/*
+ * Content of all writable registers of a device: Configuration, THIGH, TLOW,
+ * TCRIT and THYST.
+ *
+ * apply() reads the current values with one block read of addresses 3 to 10 and
+ * writes only the registers that differ; after a RESET the device is known to
+ * hold the power-on defaults, so applyAfterReset() writes without reading at all.
+ * Limits and THYST are written before Configuration, so a device leaving shutdown
+ * starts converting against the new setpoints.
+ *
+ * OPMODE one-shot is not a state: the device returns to shutdown after the
+ * conversion (as ADT7410_Sim models it and ADT7410_Shadow assumes), so a
+ * one-shot profile always rewrites Configuration (starting a conversion), and
+ * verification accepts OPMODE one-shot or shutdown then.
+ */
+struct ADT7410_Profile
+{
+	/* Register bits, as returned by diff() */
+	enum
+	{
+		CONFIGURATION = 1 << 0,
+		THIGH = 1 << 1,
+		TLOW = 1 << 2,
+		TCRIT = 1 << 3,
+		THYST = 1 << 4,
+		ALL = CONFIGURATION | THIGH | TLOW | TCRIT | THYST
+	};
+
+	enum Result
+	{
+		OK,
+		BUS_ERROR,      // a transaction reported an error(), the device may be partially written
+		VERIFY_FAILED   // the read back differs from the profile
+	};
+
+	uint8_t configuration;
+	uint16_t thigh;
+	uint16_t tlow;
+	uint16_t tcrit;
+	uint8_t thyst;
+
+	/* The power-on defaults */
+	static ADT7410_Profile defaults();
+
+	/* Registers whose values differ from other */
+	uint8_t diff(const ADT7410_Profile &other) const;
+
+	bool operator==(const ADT7410_Profile &other) const
+	{
+		return !diff(other);
+	}
+
+	bool operator!=(const ADT7410_Profile &other) const
+	{
+		return diff(other) != 0;
+	}
+
+	/* Read the profile of a device in one block read */
+	Result snapshot(ADT7410_Base &device);
+
+	/*
+	 * Write the registers that differ from the device's current values, optionally
+	 * reading them back. written receives the register bits that were written.
+	 */
+	Result apply(ADT7410_Base &device, bool verify = false, uint8_t *written = 0) const;
+
+	/* Like apply(), with the current values already known (e.g. from an earlier snapshot) */
+	Result apply(ADT7410_Base &device, const ADT7410_Profile &current, bool verify = false, uint8_t *written = 0) const;
+
+	/* Reprogram a device that was just RESET, without reading it first */
+	Result applyAfterReset(ADT7410_Base &device, bool verify = false, uint8_t *written = 0) const
+	{
+		return apply(device, defaults(), verify, written);
+	}
+
+	/*
+	 * Put a snapshot back: RESET the device, wait out the reset and apply.
+	 * The RESET_TIME wait goes through sleep (default ADT7410_sleep); pass
+	 * ADT7410_SimClock::sleepHook and the clock to restore a simulated device.
+	 */
+	Result restore(ADT7410_Base &device, bool verify = true, uint8_t *written = 0,
+		ADT7410_SleepHook sleep = 0, void *context = 0) const;
+
+private:
+	/* Decode the 8 bytes of addresses 3 to 10 */
+	void unpack(const uint8_t *buffer);
+	Result verify(ADT7410_Base &device, uint8_t registers) const;
+};
+
+#endif /* ADT7410_PROFILE_HPP */
@@ -0,0 +1,276 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Recovery.cpp
+ */
+
+#include "ADT7410_Recovery.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+ADT7410_Recovery::ADT7410_Recovery()
+	: attempts(3), backoff(100000), threshold(3), quarantine_initial(100000000), quarantine_max(60000000000ull),
+	  now_hook(0), clock_context(0)
+{
+}
+
+uint16_t ADT7410_Recovery::addDevice(ADT7410_Base &device)
+{
+	if (devices.size() >= INVALID_DEVICE)
+		return INVALID_DEVICE;
+	Device d;
+	memset(&d, 0, sizeof(d));
+	d.device = &device;
+	d.hold = quarantine_initial;
+	devices.push_back(d);
+	return uint16_t(devices.size() - 1);
+}
+
+void ADT7410_Recovery::setRetry(uint32_t attempts, uint64_t backoff)
+{
+	this->attempts = attempts ? attempts : 1;
+	this->backoff = backoff;
+}
+
+void ADT7410_Recovery::setQuarantineThreshold(uint32_t calls)
+{
+	threshold = calls ? calls : 1;
+}
+
+void ADT7410_Recovery::setQuarantineTime(uint64_t initial, uint64_t max)
+{
+	quarantine_initial = initial;
+	quarantine_max = max;
+	for (size_t i = 0; i < devices.size(); i++)
+		if (!devices[i].quarantined)
+			devices[i].hold = initial;
+}
+
+void ADT7410_Recovery::setClock(ADT7410_NowHook now, void *context)
+{
+	now_hook = now;
+	clock_context = context;
+}
+
+uint64_t ADT7410_Recovery::now()
+{
+	return now_hook ? now_hook(clock_context) : ADT7410_now();
+}
+
+int ADT7410_Recovery::read8(uint16_t device, uint16_t address, uint8_t &value, uint64_t deadline)
+{
+	Access a = { READ8, address, 0, ADT7410_Base::Snapshot() };
+	int e = call(device, a, deadline);
+	if (!e)
+		value = uint8_t(a.value);
+	return e;
+}
+
+int ADT7410_Recovery::read16(uint16_t device, uint16_t address, uint16_t &value, uint64_t deadline)
+{
+	Access a = { READ16, address, 0, ADT7410_Base::Snapshot() };
+	int e = call(device, a, deadline);
+	if (!e)
+		value = a.value;
+	return e;
+}
+
+int ADT7410_Recovery::write8(uint16_t device, uint16_t address, uint8_t value, uint64_t deadline)
+{
+	Access a = { WRITE8, address, value, ADT7410_Base::Snapshot() };
+	return call(device, a, deadline);
+}
+
+int ADT7410_Recovery::write16(uint16_t device, uint16_t address, uint16_t value, uint64_t deadline)
+{
+	Access a = { WRITE16, address, value, ADT7410_Base::Snapshot() };
+	return call(device, a, deadline);
+}
+
+int ADT7410_Recovery::readSnapshot(uint16_t device, ADT7410_Base::Snapshot &snapshot, uint64_t deadline)
+{
+	Access a = { SNAPSHOT, 0, 0, ADT7410_Base::Snapshot() };
+	int e = call(device, a, deadline);
+	if (!e)
+		snapshot = a.snapshot;
+	return e;
+}
+
+int ADT7410_Recovery::reset(uint16_t device, uint64_t deadline)
+{
+	Access a = { RESET, ADT7410_Base::RESET::__address, 0, ADT7410_Base::Snapshot() };
+	return call(device, a, deadline);
+}
+
+int ADT7410_Recovery::attempt(Device &d, Access &access)
+{
+	ADT7410_Base &device = *d.device;
+	d.stats.transactions++;
+	switch (access.op)
+	{
+	case READ8:
+	{
+		uint8_t value = 0;
+		int e = device.tryRead8(access.address, value);
+		access.value = value;
+		return e;
+	}
+	case READ16:
+		return device.tryRead16(access.address, access.value);
+	case WRITE8:
+		return device.tryWrite8(access.address, uint8_t(access.value));
+	case WRITE16:
+		return device.tryWrite16(access.address, access.value);
+	case SNAPSHOT:
+		return device.tryReadSnapshot(access.snapshot);
+	default:
+	{
+		int e = device.trySetRESET();
+		if (!e)
+			d.until = now() + ADT7410_Base::RESET_TIME;
+		return e;
+	}
+	}
+}
+
+bool ADT7410_Recovery::admit(Device &d, uint64_t now, uint64_t deadline, int &error)
+{
+	if (d.quarantined)
+	{
+		if (now < d.until)
+		{
+			d.stats.rejected++;
+			error = EAGAIN;
+			return false;
+		}
+
+		/* Quarantine over: the device has to identify itself before it is used again, on the next call */
+		uint8_t id = 0;
+		d.stats.probes++;
+		d.stats.transactions++;
+		int e = d.device->tryRead8(ADT7410_Base::ID::__address, id);
+		if (e || ADT7410_Base::get<ADT7410_Base::ID::MANUFACTURER_ID>(id) != ADT7410_Base::ID::MANUFACTURER_ID::dflt)
+		{
+			d.stats.probeFailures++;
+			d.stats.failures++;
+			d.hold = d.hold * 2 < quarantine_max ? d.hold * 2 : quarantine_max;
+			d.until = now + d.hold;
+			error = e ? e : ENODEV;
+			return false;
+		}
+		d.quarantined = false;
+		d.failures = 0;
+		d.tries = 0;
+		d.hold = quarantine_initial;
+		d.until = now;
+		error = EAGAIN;
+		return false;
+	}
+
+	if (now < d.until)
+	{
+		/* Backoff or reset window: come back when it ends, if the deadline allows */
+		d.stats.rejected++;
+		error = deadline < d.until ? EBUSY : EAGAIN;
+		return false;
+	}
+	return true;
+}
+
+void ADT7410_Recovery::failed(Device &d, uint64_t now)
+{
+	d.tries = 0;
+	if (++d.failures < threshold)
+		return;
+	d.quarantined = true;
+	d.until = now + d.hold;
+	d.stats.quarantines++;
+}
+
+int ADT7410_Recovery::call(uint16_t device, Access &access, uint64_t deadline)
+{
+	if (device >= devices.size())
+		return EINVAL;
+	Device &d = devices[device];
+	d.stats.calls++;
+
+	int error;
+	if (!admit(d, now(), deadline, error))
+	{
+		if (error == EBUSY)
+			d.tries = 0;
+		return error;
+	}
+
+	int e = attempt(d, access);
+	if (!e)
+	{
+		if (d.tries)
+			d.stats.recovered++;
+		d.tries = 0;
+		d.failures = 0;
+		return 0;
+	}
+	d.stats.failures++;
+
+	uint64_t time = now();
+	if (!d.tries)
+		d.wait = backoff;
+	if (++d.tries >= attempts || time + d.wait > deadline)
+	{
+		d.stats.gaveUp++;
+		failed(d, time);
+		return e;
+	}
+
+	/* The caller repeats the access once the backoff is over */
+	d.stats.retries++;
+	d.until = time + d.wait;
+	d.wait *= 2;
+	return EAGAIN;
+}
+
+bool ADT7410_Recovery::isQuarantined(uint16_t device, uint64_t now) const
+{
+	const Device &d = devices[device];
+	return d.quarantined && now < d.until;
+}
+
+ADT7410_Recovery::State ADT7410_Recovery::getState(uint16_t device) const
+{
+	const Device &d = devices[device];
+	return d.quarantined ? QUARANTINED : d.failures ? FAILING : HEALTHY;
+}
+
+ADT7410_Recovery::Stats ADT7410_Recovery::getTotals() const
+{
+	Stats t;
+	memset(&t, 0, sizeof(t));
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		const Stats &s = devices[i].stats;
+		t.calls += s.calls;
+		t.transactions += s.transactions;
+		t.failures += s.failures;
+		t.retries += s.retries;
+		t.recovered += s.recovered;
+		t.gaveUp += s.gaveUp;
+		t.rejected += s.rejected;
+		t.quarantines += s.quarantines;
+		t.probes += s.probes;
+		t.probeFailures += s.probeFailures;
+	}
+	return t;
+}
+
+void ADT7410_Recovery::resetStats()
+{
+	for (size_t i = 0; i < devices.size(); i++)
+		memset(&devices[i].stats, 0, sizeof(devices[i].stats));
+}
@@ -0,0 +1,172 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Recovery.hpp
+ */
+
+#ifndef ADT7410_RECOVERY_HPP
+#define ADT7410_RECOVERY_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <vector>
+
+/*
+ * Fault handling for the devices of one bus, on top of the try* transport calls.
+ *
+ * No call ever sleeps, and each issues at most one transaction. A device that
+ * cannot be accessed yet returns EAGAIN without touching the bus, and
+ * getRetryAt() tells when to call again; a scheduler skips it until then and
+ * services its bus-mates, like ADT7410_Acquisition skips backed-off devices.
+ *
+ * Every access carries a deadline. A failed transaction is retried after an
+ * exponentially growing backoff, but only while the backoff still ends before
+ * the deadline: the call returns EAGAIN and the caller repeats the same access
+ * at getRetryAt(). Once the attempts are used up or no time is left, the call
+ * returns the error. A device failing that many accesses in a row is
+ * quarantined: its calls return EAGAIN until the quarantine ends. The next
+ * call then only re-probes the device by reading ID and checking
+ * MANUFACTURER_ID: a failed probe doubles the quarantine, a successful one ends
+ * it and returns EAGAIN with getRetryAt() at once, so the access itself is the
+ * transaction of the following call.
+ * After reset() the device is left alone for the RESET_TIME it NACKs: an access
+ * whose deadline ends before that returns EBUSY, an earlier call EAGAIN.
+ *
+ * Errors are the transport's error() values (e.g. ENXIO for a NACK). The time
+ * base is ADT7410_now() unless setClock() replaces it. Not thread-safe: use one
+ * instance per bus worker.
+ */
+class ADT7410_Recovery
+{
+public:
+	enum State
+	{
+		HEALTHY,
+		FAILING,      // recent failures, below the quarantine threshold
+		QUARANTINED
+	};
+
+	struct Stats
+	{
+		uint64_t calls;         // including the repeated calls of retried accesses
+		uint64_t transactions;  // bus transactions issued, including retries and probes
+		uint64_t failures;      // failed transactions
+		uint64_t retries;       // retries scheduled after a failed transaction
+		uint64_t recovered;     // calls that succeeded after a retry
+		uint64_t gaveUp;        // calls that failed, retries exhausted or no time left
+		uint64_t rejected;      // calls refused without bus access (backoff, quarantine, reset window)
+		uint64_t quarantines;
+		uint64_t probes;        // calls spent on the ID probe at the end of a quarantine
+		uint64_t probeFailures;
+	};
+
+	/* Returned by addDevice() on failure */
+	enum { INVALID_DEVICE = 0xFFFF };
+
+	ADT7410_Recovery();
+
+	uint16_t addDevice(ADT7410_Base &device);
+
+	/* Attempts per call and the backoff before the first retry (doubling per retry), default 3 and 100 µs */
+	void setRetry(uint32_t attempts, uint64_t backoff);
+
+	/* Consecutive failed calls before quarantine, default 3 */
+	void setQuarantineThreshold(uint32_t calls);
+
+	/* First and longest quarantine (nanoseconds), default 100 ms and 60 s */
+	void setQuarantineTime(uint64_t initial, uint64_t max);
+
+	/* Time base of deadlines and backoffs, ADT7410_now() if now is 0 */
+	void setClock(ADT7410_NowHook now, void *context);
+
+	/* Register accesses, 0, EAGAIN (call again at getRetryAt()) or an error; deadline is absolute, on the time base */
+	int read8(uint16_t device, uint16_t address, uint8_t &value, uint64_t deadline);
+	int read16(uint16_t device, uint16_t address, uint16_t &value, uint64_t deadline);
+	int write8(uint16_t device, uint16_t address, uint8_t value, uint64_t deadline);
+	int write16(uint16_t device, uint16_t address, uint16_t value, uint64_t deadline);
+	int readSnapshot(uint16_t device, ADT7410_Base::Snapshot &snapshot, uint64_t deadline);
+
+	/* Issue RESET and keep off the bus while the device reloads its defaults */
+	int reset(uint16_t device, uint64_t deadline);
+
+	/* Whether calls for the device would currently be refused */
+	bool isQuarantined(uint16_t device, uint64_t now) const;
+
+	State getState(uint16_t device) const;
+
+	/* Earliest time a call for the device is admitted again, after it returned EAGAIN */
+	uint64_t getRetryAt(uint16_t device) const
+	{
+		return devices[device].until;
+	}
+
+	/* Time the quarantine of a device ends, 0 if not quarantined */
+	uint64_t getQuarantineEnd(uint16_t device) const
+	{
+		return devices[device].quarantined ? devices[device].until : 0;
+	}
+
+	const Stats &getStats(uint16_t device) const
+	{
+		return devices[device].stats;
+	}
+
+	/* Statistics summed over all devices */
+	Stats getTotals() const;
+
+	void resetStats();
+
+private:
+	enum Op
+	{
+		READ8,
+		READ16,
+		WRITE8,
+		WRITE16,
+		SNAPSHOT,
+		RESET
+	};
+
+	struct Device
+	{
+		ADT7410_Base *device;
+		uint32_t failures;    // consecutive failed calls
+		bool quarantined;
+		uint32_t tries;       // failed attempts of the access being retried
+		uint64_t wait;        // backoff before its next retry
+		uint64_t until;       // end of the backoff, quarantine or reset window
+		uint64_t hold;        // length of the current quarantine
+		Stats stats;
+	};
+
+	struct Access
+	{
+		Op op;
+		uint16_t address;
+		uint16_t value;
+		ADT7410_Base::Snapshot snapshot;
+	};
+
+	uint64_t now();
+	int call(uint16_t device, Access &access, uint64_t deadline);
+	int attempt(Device &d, Access &access);
+	bool admit(Device &d, uint64_t now, uint64_t deadline, int &error);
+	void failed(Device &d, uint64_t now);
+
+	std::vector<Device> devices;
+	uint32_t attempts;
+	uint64_t backoff;
+	uint32_t threshold;
+	uint64_t quarantine_initial;
+	uint64_t quarantine_max;
+	ADT7410_NowHook now_hook;
+	void *clock_context;
+};
+
+#endif /* ADT7410_RECOVERY_HPP */
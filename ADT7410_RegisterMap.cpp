@@ -0,0 +1,261 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_RegisterMap.cpp
+ */
+
+#include "ADT7410_RegisterMap.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+typedef ADT7410_RegisterDescriptor D;
+
+/* Value of a field, shifted down */
+static uint16_t field(uint16_t raw, uint16_t mask)
+{
+	if (!mask)
+		return 0;
+	raw &= mask;
+	while (!(mask & 1))
+	{
+		mask >>= 1;
+		raw >>= 1;
+	}
+	return raw;
+}
+
+static bool canRead(const ADT7410_RegisterDescriptor &reg)
+{
+	return (reg.access & D::READ) && reg.width && reg.address + reg.width / 8 <= ADT7410_RegisterMap::BYTES;
+}
+
+uint32_t ADT7410_RegisterMap::bit(const char *name)
+{
+	const ADT7410_RegisterDescriptor *reg = ADT7410_findRegister(name);
+	return reg ? uint32_t(1) << (reg - ADT7410_registers) : 0;
+}
+
+uint32_t ADT7410_RegisterMap::readable()
+{
+	uint32_t mask = 0;
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+		if (canRead(ADT7410_registers[i]))
+			mask |= uint32_t(1) << i;
+	return mask;
+}
+
+uint32_t ADT7410_RegisterMap::nonVolatile()
+{
+	uint32_t mask = 0;
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+		if (canRead(ADT7410_registers[i]) && !ADT7410_registers[i].isVolatile)
+			mask |= uint32_t(1) << i;
+	return mask;
+}
+
+size_t ADT7410_RegisterMap::plan(uint32_t registers, Burst *bursts, size_t max)
+{
+	/* Bytes wanted, and bytes that must not be read because their register was not asked for */
+	bool wanted[BYTES], forbidden[BYTES];
+	memset(wanted, 0, sizeof(wanted));
+	memset(forbidden, 0, sizeof(forbidden));
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+	{
+		const ADT7410_RegisterDescriptor &reg = ADT7410_registers[i];
+		if (!canRead(reg))
+			continue;
+		bool selected = (registers >> i) & 1;
+		for (uint16_t a = reg.address; a < reg.address + reg.width / 8; a++)
+		{
+			if (selected)
+				wanted[a] = true;
+			else if (reg.isVolatile)
+				forbidden[a] = true;
+		}
+	}
+
+	size_t n = 0;
+	int start = -1, end = 0;
+	for (int a = 0; a < BYTES; a++)
+	{
+		if (!wanted[a])
+			continue;
+		bool bridge = start >= 0;
+		for (int g = end; bridge && g < a; g++)
+			if (forbidden[g])
+				bridge = false;
+		if (!bridge)
+		{
+			if (start >= 0)
+			{
+				if (n < max)
+				{
+					bursts[n].address = uint16_t(start);
+					bursts[n].length = uint16_t(end - start);
+				}
+				n++;
+			}
+			start = a;
+		}
+		end = a + 1;
+	}
+	if (start >= 0)
+	{
+		if (n < max)
+		{
+			bursts[n].address = uint16_t(start);
+			bursts[n].length = uint16_t(end - start);
+		}
+		n++;
+	}
+	return n;
+}
+
+ADT7410_RegisterMap::ADT7410_RegisterMap()
+	: valid(0)
+{
+	memset(bytes, 0, sizeof(bytes));
+}
+
+int ADT7410_RegisterMap::read(ADT7410_Base &device, uint32_t registers)
+{
+	Burst bursts[BYTES];
+	size_t n = plan(registers, bursts, BYTES);
+	bool got[BYTES];
+	memset(got, 0, sizeof(got));
+	int error = 0;
+	for (size_t b = 0; b < n; b++)
+	{
+		int e = device.tryReadBlock(bursts[b].address, bytes + bursts[b].address, bursts[b].length);
+		if (e)
+		{
+			if (!error)
+				error = e;
+			continue;
+		}
+		for (uint16_t a = bursts[b].address; a < bursts[b].address + bursts[b].length; a++)
+			got[a] = true;
+	}
+
+	/* A register is valid if all its bytes came in; unrequested bytes read on the way count too */
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+	{
+		const ADT7410_RegisterDescriptor &reg = ADT7410_registers[i];
+		if (!canRead(reg))
+			continue;
+		bool complete = true;
+		for (uint16_t a = reg.address; a < reg.address + reg.width / 8; a++)
+			complete = complete && got[a];
+		if (complete)
+			valid |= uint32_t(1) << i;
+		else if ((registers >> i) & 1)
+			valid &= ~(uint32_t(1) << i);
+	}
+	return error;
+}
+
+uint16_t ADT7410_RegisterMap::value(const ADT7410_RegisterDescriptor &reg) const
+{
+	if (!canRead(reg))
+		return 0;
+	return reg.width == 16 ? uint16_t((bytes[reg.address] << 8) | bytes[reg.address + 1]) : bytes[reg.address];
+}
+
+uint32_t ADT7410_RegisterMap::differing(const ADT7410_RegisterMap &other, uint32_t registers) const
+{
+	uint32_t mask = 0;
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+		if (((registers & valid & other.valid) >> i) & 1
+			&& value(ADT7410_registers[i]) != other.value(ADT7410_registers[i]))
+			mask |= uint32_t(1) << i;
+	return mask;
+}
+
+std::string ADT7410_RegisterMap::describe(const ADT7410_RegisterDescriptor &reg, uint16_t raw) const
+{
+	char text[64];
+	switch (reg.format)
+	{
+	case D::TEMPERATURE:
+	{
+		/* A TEMPERATURE word of a 13-bit device carries flags in its low bits */
+		uint32_t configuration = bit("Configuration");
+		if (reg.address == ADT7410_Base::TEMPERATURE::__address && (valid & configuration)
+			&& ADT7410_Base::get<ADT7410_Base::Configuration::RESOLUTION>(bytes[ADT7410_Base::Configuration::__address])
+				== ADT7410_Base::Configuration::RESOLUTION::RES_13_BIT)
+			raw &= uint16_t(ADT7410_Base::TEMPERATURE::TEMPERATURE_::mask | ADT7410_Base::TEMPERATURE::SIGN::mask);
+		snprintf(text, sizeof(text), "  %.4f °C", int16_t(raw) / 128.0);
+		return text;
+	}
+	case D::HYSTERESIS:
+		snprintf(text, sizeof(text), "  %u °C", unsigned(ADT7410_Base::get<ADT7410_Base::THYST::HYSTERESIS>(raw)));
+		return text;
+	default:
+		return "";
+	}
+}
+
+std::string ADT7410_RegisterMap::dump(uint32_t registers) const
+{
+	std::string out;
+	char line[160];
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+	{
+		const ADT7410_RegisterDescriptor &reg = ADT7410_registers[i];
+		if (!((registers >> i) & 1) || !canRead(reg))
+			continue;
+		if (!isValid(i))
+		{
+			snprintf(line, sizeof(line), "%-14s 0x%02x = (not read)\n", reg.name, unsigned(reg.address));
+			out += line;
+			continue;
+		}
+		uint16_t raw = value(reg);
+		snprintf(line, sizeof(line), reg.width == 16 ? "%-14s 0x%02x = 0x%04x%s\n" : "%-14s 0x%02x = 0x%02x%s\n",
+			reg.name, unsigned(reg.address), unsigned(raw), describe(reg, raw).c_str());
+		out += line;
+		for (size_t f = 0; f < reg.fieldCount; f++)
+		{
+			const ADT7410_FieldDescriptor &fd = reg.fields[f];
+			uint16_t v = field(raw, fd.mask);
+			const char *name = ADT7410_valueName(fd, v);
+			snprintf(line, sizeof(line), "    %-18s = %u%s%s%s  %s\n", fd.name, unsigned(v),
+				name ? " (" : "", name ? name : "", name ? ")" : "", fd.description);
+			out += line;
+		}
+	}
+	return out;
+}
+
+std::string ADT7410_RegisterMap::diff(const ADT7410_RegisterMap &other, uint32_t registers) const
+{
+	std::string out;
+	char line[160];
+	uint32_t changed = differing(other, registers);
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+	{
+		if (!((changed >> i) & 1))
+			continue;
+		const ADT7410_RegisterDescriptor &reg = ADT7410_registers[i];
+		uint16_t a = value(reg), b = other.value(reg);
+		for (size_t f = 0; f < reg.fieldCount; f++)
+		{
+			const ADT7410_FieldDescriptor &fd = reg.fields[f];
+			uint16_t va = field(a, fd.mask), vb = field(b, fd.mask);
+			if (va == vb)
+				continue;
+			const char *na = ADT7410_valueName(fd, va), *nb = ADT7410_valueName(fd, vb);
+			snprintf(line, sizeof(line), "%s.%s: %u%s%s%s -> %u%s%s%s\n", reg.name, fd.name,
+				unsigned(va), na ? " (" : "", na ? na : "", na ? ")" : "",
+				unsigned(vb), nb ? " (" : "", nb ? nb : "", nb ? ")" : "");
+			out += line;
+		}
+	}
+	return out;
+}
@@ -0,0 +1,87 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_RegisterMap.hpp
+ */
+
+#ifndef ADT7410_REGISTERMAP_HPP
+#define ADT7410_REGISTERMAP_HPP
+
+#include "ADT7410_Descriptor.hpp"
+
+#include <string>
+
+/*
+ * Local copy of a device's readable registers, driven by the descriptor table.
+ *
+ * Registers are selected by a mask with bit i for ADT7410_registers[i]. read()
+ * plans the fewest block reads that cover the selection: runs of requested
+ * registers are merged across unrequested ones as long as no volatile register
+ * (TEMPERATURE, Status) is read that was not asked for, since reading those
+ * clears nRDY or the Status flags. Every field is then decoded locally.
+ */
+class ADT7410_RegisterMap
+{
+public:
+	/* Addresses 0 to 11 */
+	enum { BYTES = 12 };
+
+	/* One block read */
+	struct Burst
+	{
+		uint16_t address;
+		uint16_t length;
+	};
+
+	/* Mask bit of a register, 0 if unknown */
+	static uint32_t bit(const char *name);
+
+	/* All registers that can be read, and those without read side effects */
+	static uint32_t readable();
+	static uint32_t nonVolatile();
+
+	/* Plan the block reads for a selection, returns their number (at most max are stored) */
+	static size_t plan(uint32_t registers, Burst *bursts, size_t max);
+
+	ADT7410_RegisterMap();
+
+	/* Read the selected registers in as few block reads as possible, returns 0 or the first error */
+	int read(ADT7410_Base &device, uint32_t registers);
+
+	/* Registers holding a value */
+	uint32_t getValid() const
+	{
+		return valid;
+	}
+
+	/* Raw value of a register that was read */
+	uint16_t value(const ADT7410_RegisterDescriptor &reg) const;
+
+	/* Registers of the selection whose values differ between both maps (valid in both) */
+	uint32_t differing(const ADT7410_RegisterMap &other, uint32_t registers) const;
+
+	/* Text dump of the selected registers with every field decoded */
+	std::string dump(uint32_t registers) const;
+
+	/* Field-level differences, one "register.field: old -> new" line each */
+	std::string diff(const ADT7410_RegisterMap &other, uint32_t registers) const;
+
+private:
+	bool isValid(size_t index) const
+	{
+		return (valid >> index) & 1;
+	}
+
+	/* The register value in human units, appended after the raw value */
+	std::string describe(const ADT7410_RegisterDescriptor &reg, uint16_t raw) const;
+
+	uint8_t bytes[BYTES];
+	uint32_t valid;
+};
+
+#endif /* ADT7410_REGISTERMAP_HPP */
@@ -0,0 +1,178 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Ring.hpp
+ */
+
+#ifndef ADT7410_RING_HPP
+#define ADT7410_RING_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Atomic.hpp"
+
+#include <cstddef>
+
+/* One timestamped sample as it leaves the acquisition */
+struct ADT7410_Sample
+{
+	uint64_t timestamp;     // monotonic time, nanoseconds
+	uint16_t device;        // device id
+	uint16_t temperature;   // raw TEMPERATURE word
+	uint8_t status;         // raw Status byte
+	uint8_t configuration;  // raw Configuration byte (resolution the sample was taken with)
+};
+
+/*
+ * Bounded lock-free ring of samples between exactly one producer thread
+ * (the acquisition) and one consumer thread.
+ * The producer and consumer indices live on separate cache lines and each
+ * side keeps a private copy of the other's index, so the shared lines are
+ * only touched when the ring looks full or empty.
+ * When full, the ring either drops the new sample (DROP_NEWEST) or discards
+ * the oldest unread one (OVERWRITE_OLDEST); both are counted.
+ */
+class ADT7410_SampleRing
+{
+public:
+	enum Policy
+	{
+		DROP_NEWEST,
+		OVERWRITE_OLDEST
+	};
+
+	/* capacity is rounded up to a power of two */
+	ADT7410_SampleRing(uint32_t capacity, Policy policy = DROP_NEWEST)
+		: slots(0), mask(0), policy(policy), head(0), tail(0), cached_head(0), dropped(0), overwritten(0), cached_tail(0)
+	{
+		uint32_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		mask = size - 1;
+		slots = new ADT7410_Sample[size];
+	}
+
+	~ADT7410_SampleRing()
+	{
+		delete[] slots;
+	}
+
+	uint32_t getCapacity() const
+	{
+		return mask + 1;
+	}
+
+	Policy getPolicy() const
+	{
+		return policy;
+	}
+
+	/* Producer: append a sample, returns false if it was dropped */
+	bool push(const ADT7410_Sample &sample)
+	{
+		uint32_t t = tail;
+		if (t - cached_head > mask)
+		{
+			cached_head = ADT7410_loadAcquire(&head);
+			while (t - cached_head > mask)
+			{
+				if (policy == DROP_NEWEST)
+				{
+					ADT7410_fetchAdd(&dropped, 1);
+					return false;
+				}
+				/* Discard the oldest sample, unless the consumer takes it first */
+				if (ADT7410_compareExchange(&head, cached_head, cached_head + 1))
+					ADT7410_fetchAdd(&overwritten, 1);
+				cached_head = ADT7410_loadAcquire(&head);
+			}
+		}
+		slots[t & mask] = sample;
+		ADT7410_storeRelease(&tail, t + 1);
+		return true;
+	}
+
+	/* Consumer: take one sample, returns false if the ring is empty */
+	bool pop(ADT7410_Sample &sample)
+	{
+		return pop(&sample, 1) == 1;
+	}
+
+	/* Consumer: take up to max samples, returns the number taken */
+	uint32_t pop(ADT7410_Sample *samples, uint32_t max)
+	{
+		for (;;)
+		{
+			uint32_t h = ADT7410_loadAcquire(&head);
+			uint32_t available = cached_tail - h;
+			/* The producer may have moved head past the cached tail (OVERWRITE_OLDEST) */
+			if (available < max || available > mask + 1)
+			{
+				cached_tail = ADT7410_loadAcquire(&tail);
+				available = cached_tail - h;
+			}
+			uint32_t n = available < max ? available : max;
+			if (n == 0)
+				return 0;
+			for (uint32_t i = 0; i < n; i++)
+				samples[i] = slots[(h + i) & mask];
+			if (policy == DROP_NEWEST)
+			{
+				ADT7410_storeRelease(&head, h + n);
+				return n;
+			}
+			/* The producer may have overwritten what was copied, then the exchange fails and we retry */
+			if (ADT7410_compareExchange(&head, h, h + n))
+				return n;
+		}
+	}
+
+	/* Samples currently in the ring (approximate while both sides run) */
+	uint32_t size() const
+	{
+		return ADT7410_loadAcquire(&tail) - ADT7410_loadAcquire(&head);
+	}
+
+	/* New samples dropped because the ring was full (DROP_NEWEST) */
+	uint32_t getDropped() const
+	{
+		return ADT7410_loadAcquire(&dropped);
+	}
+
+	/* Unread samples discarded to make room (OVERWRITE_OLDEST) */
+	uint32_t getOverwritten() const
+	{
+		return ADT7410_loadAcquire(&overwritten);
+	}
+
+private:
+	ADT7410_SampleRing(const ADT7410_SampleRing &);
+	ADT7410_SampleRing &operator=(const ADT7410_SampleRing &);
+
+	/* Read-only after construction */
+	ADT7410_Sample *slots;
+	uint32_t mask;
+	Policy policy;
+	char pad0[ADT7410_CACHE_LINE];
+
+	/* Consumer index, also advanced by the producer in OVERWRITE_OLDEST */
+	volatile uint32_t head;
+	char pad1[ADT7410_CACHE_LINE - sizeof(uint32_t)];
+
+	/* Producer side */
+	volatile uint32_t tail;
+	uint32_t cached_head;
+	volatile uint32_t dropped;
+	volatile uint32_t overwritten;
+	char pad2[ADT7410_CACHE_LINE - 4 * sizeof(uint32_t)];
+
+	/* Consumer side */
+	uint32_t cached_tail;
+	char pad3[ADT7410_CACHE_LINE - sizeof(uint32_t)];
+};
+
+#endif /* ADT7410_RING_HPP */
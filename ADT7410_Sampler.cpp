@@ -0,0 +1,213 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sampler.cpp
+ */
+
+#include "ADT7410_Sampler.hpp"
+
+#include <cstring>
+
+typedef ADT7410_Base::Configuration::OPMODE OPMODE;
+
+ADT7410_Sampler::ADT7410_Sampler(ADT7410_Shadow &shadow, uint8_t opmode)
+	: shadow(shadow), opmode(opmode), poll_interval(1000000), last_ready(0), burst(false), last_error(0),
+	  now_hook(0), sleep_hook(0), clock_context(0)
+{
+	switch (opmode)
+	{
+	case OPMODE::ONE_SPS:
+		nominal = ADT7410_Base::ONE_SPS_CONVERSION_TIME;
+		period = ADT7410_Base::ONE_SPS_PERIOD;
+		break;
+	case OPMODE::CONTINOUS_CONVERSIO:
+		nominal = ADT7410_Base::CONVERSION_TIME;
+		period = ADT7410_Base::CONVERSION_TIME;
+		break;
+	default:
+		nominal = ADT7410_Base::CONVERSION_TIME;
+		period = 0;
+		break;
+	}
+	window = period ? period : nominal;
+	resetStats();
+}
+
+void ADT7410_Sampler::setPollInterval(uint64_t interval)
+{
+	poll_interval = interval ? interval : 1;
+}
+
+void ADT7410_Sampler::setBurst(bool burst)
+{
+	this->burst = burst;
+}
+
+void ADT7410_Sampler::setClock(ADT7410_NowHook now, ADT7410_SleepHook sleep, void *context)
+{
+	now_hook = now;
+	sleep_hook = sleep;
+	clock_context = context;
+	shadow.setClock(now, context);
+}
+
+uint64_t ADT7410_Sampler::now()
+{
+	return now_hook ? now_hook(clock_context) : ADT7410_now();
+}
+
+void ADT7410_Sampler::sleep(uint64_t duration)
+{
+	if (sleep_hook)
+		sleep_hook(duration, clock_context);
+	else
+		ADT7410_sleep(duration);
+}
+
+void ADT7410_Sampler::sleepUntil(uint64_t time)
+{
+	if (!sleep_hook && !now_hook)
+	{
+		ADT7410_sleepUntil(time);
+		return;
+	}
+	uint64_t current = now();
+	if (time > current)
+		sleep(time - current);
+}
+
+uint32_t ADT7410_Sampler::transactions(uint8_t opmode, bool burst)
+{
+	/* Keep in line with arm() and check() */
+	uint32_t arming = opmode == OPMODE::ONE_SHOT ? 1 : 0;
+	return arming + (burst ? 1 : 2);
+}
+
+void ADT7410_Sampler::resetStats()
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+int ADT7410_Sampler::arm(uint64_t &reference)
+{
+	if (!period)
+	{
+		/* Writing the one-shot bits starts a conversion even if they are already set */
+		uint8_t configuration = shadow.getConfiguration();
+		if (shadow.error())
+			return shadow.error();
+		int e = shadow.setConfiguration(uint8_t(ADT7410_Base::set<OPMODE>(configuration, opmode)));
+		reference = now();
+		return e;
+	}
+
+	/* Periodic modes: a mode change restarts the conversion cycle */
+	bool written = shadow.set<OPMODE>(ADT7410_Base::Configuration::__address, opmode);
+	if (shadow.error())
+		return shadow.error();
+	if (written)
+		last_ready = now() - window + nominal;
+	reference = last_ready;
+	return 0;
+}
+
+int ADT7410_Sampler::check(ADT7410_Base::Snapshot &snapshot, bool &ready)
+{
+	ADT7410_Base &device = shadow.getDevice();
+	stats.checks++;
+	ready = false;
+	if (burst)
+	{
+		/* The Status byte of the block reflects nRDY before the TEMPERATURE read resets it */
+		int e = device.tryReadSnapshot(snapshot);
+		ready = !e && !(snapshot.status & ADT7410_Base::Status::nRDY::mask);
+		return e;
+	}
+	int e = device.tryRead8(ADT7410_Base::Status::__address, snapshot.status);
+	if (e || (snapshot.status & ADT7410_Base::Status::nRDY::mask))
+		return e;
+	e = device.tryRead16(ADT7410_Base::TEMPERATURE::__address, snapshot.temperature);
+	if (e)
+		return e;
+	snapshot.configuration = shadow.getConfiguration();
+	if (shadow.error())
+		return shadow.error();
+	ready = true;
+	return 0;
+}
+
+void ADT7410_Sampler::adapt(uint64_t latency, bool late)
+{
+	if (late)
+		window = latency + latency / 16;
+	else
+		window -= window / 64;
+
+	uint64_t low = nominal / 2;
+	uint64_t high = 2 * (period > nominal ? period : nominal);
+	if (window < low)
+		window = low;
+	if (window > high)
+		window = high;
+}
+
+bool ADT7410_Sampler::sample(ADT7410_Base::Snapshot &snapshot, uint64_t timeout)
+{
+	uint64_t start = now();
+	uint64_t deadline = start + timeout;
+	uint64_t reference = 0;
+	last_error = arm(reference);
+	if (last_error)
+	{
+		stats.errors++;
+		return false;
+	}
+	bool phase_known = !period || reference != 0;
+	if (!phase_known)
+		reference = start;
+	uint64_t expected = phase_known ? reference + window : start;
+
+	sleepUntil(expected < deadline ? expected : deadline);
+	uint64_t checks = 1;
+	bool ready = false;
+	last_error = check(snapshot, ready);
+	while (!last_error && !ready && now() < deadline)
+	{
+		sleep(poll_interval);
+		checks++;
+		last_error = check(snapshot, ready);
+	}
+	if (last_error)
+	{
+		stats.errors++;
+		return false;
+	}
+	if (!ready)
+	{
+		stats.timeouts++;
+		return false;
+	}
+
+	uint64_t end = now();
+	uint64_t latency = end - reference;
+	if (phase_known)
+	{
+		adapt(latency, checks > 1);
+
+		/* A blind poller checks every poll interval from the reference time on */
+		uint64_t blind = latency / poll_interval + 1;
+		if (blind > checks)
+			stats.pollsAvoided += blind - checks;
+	}
+	if (checks > 1)
+		stats.late++;
+	if (period)
+		last_ready = end;
+	stats.samples++;
+	return true;
+}
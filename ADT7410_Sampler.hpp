@@ -0,0 +1,118 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sampler.hpp
+ */
+
+#ifndef ADT7410_SAMPLER_HPP
+#define ADT7410_SAMPLER_HPP
+
+#include "ADT7410_Shadow.hpp"
+#include "ADT7410_Time.hpp"
+
+/*
+ * Conversion-timing-aware sampling.
+ * Instead of polling Status::nRDY until a result lands, the sampler sleeps
+ * for the expected conversion window and confirms the result with a single
+ * Status read (or one snapshot block read). In ONE_SHOT mode every sample
+ * arms a conversion by writing the OPMODE bits; in CONTINOUS_CONVERSIO and
+ * ONE_SPS modes the next result is expected one conversion period after the
+ * previous one. The window adapts to the observed nRDY latency: it is probed
+ * downwards while results are ready on the first check and moved just past
+ * the observed latency when they are not.
+ * A failed transaction ends the sample: it is counted in Stats::errors and
+ * reported by error(), and the window does not learn from it.
+ */
+class ADT7410_Sampler
+{
+public:
+	struct Stats
+	{
+		uint64_t samples;
+		uint64_t checks;        // Status reads or snapshot reads issued to confirm a result
+		uint64_t late;          // samples not ready on the first check
+		uint64_t timeouts;      // sample() calls that gave up
+		uint64_t errors;        // sample() calls ended by a failed transaction
+		uint64_t pollsAvoided;  // nRDY polls a poller at the poll interval would have issued in addition
+	};
+
+	/* opmode is one of Configuration::OPMODE CONTINOUS_CONVERSIO, ONE_SHOT or ONE_SPS */
+	ADT7410_Sampler(ADT7410_Shadow &shadow, uint8_t opmode = ADT7410_Base::Configuration::OPMODE::ONE_SHOT);
+
+	/* Interval of follow-up checks when a result is late, default 1 ms */
+	void setPollInterval(uint64_t interval);
+
+	/* Confirm with one snapshot block read instead of Status then TEMPERATURE, default off */
+	void setBurst(bool burst);
+
+	/*
+	 * Time base, also passed on to the shadow: now (ADT7410_now() if 0) and sleep
+	 * (ADT7410_sleep() if 0), both called with context. With
+	 * ADT7410_SimClock::nowHook/sleepHook the sampler runs on a manual clock.
+	 */
+	void setClock(ADT7410_NowHook now, ADT7410_SleepHook sleep, void *context);
+
+	/*
+	 * Transactions sample() issues in a mode when the result is ready on the first
+	 * check and Configuration is shadowed: the one-shot arming write, then Status
+	 * and TEMPERATURE reads or one snapshot read. Late results add one check each.
+	 */
+	static uint32_t transactions(uint8_t opmode, bool burst);
+
+	/*
+	 * Take one fresh sample, waiting at most timeout nanoseconds.
+	 * Returns false if no conversion result was ready in time or a transaction
+	 * failed (see error()); snapshot is only valid if it returns true.
+	 */
+	bool sample(ADT7410_Base::Snapshot &snapshot, uint64_t timeout = 1000000000u);
+
+	/* Error that ended the last sample() call, 0 if it succeeded or timed out */
+	int error() const
+	{
+		return last_error;
+	}
+
+	/* Current conversion window (nanoseconds) */
+	uint64_t getWindow() const
+	{
+		return window;
+	}
+
+	const Stats &getStats() const
+	{
+		return stats;
+	}
+
+	void resetStats();
+
+private:
+	/* Arm a conversion if needed, setting the reference time of the result; returns 0 or the error */
+	int arm(uint64_t &reference);
+	/* Confirm a result; returns 0 or the error, ready tells whether the result was there */
+	int check(ADT7410_Base::Snapshot &snapshot, bool &ready);
+	void adapt(uint64_t latency, bool late);
+	uint64_t now();
+	void sleep(uint64_t duration);
+	void sleepUntil(uint64_t time);
+
+	ADT7410_Shadow &shadow;
+	uint8_t opmode;
+	uint64_t nominal;
+	uint64_t window;
+	uint64_t period;
+	uint64_t poll_interval;
+	uint64_t last_ready;
+	bool burst;
+	int last_error;
+	ADT7410_NowHook now_hook;
+	ADT7410_SleepHook sleep_hook;
+	void *clock_context;
+	Stats stats;
+};
+
+#endif /* ADT7410_SAMPLER_HPP */
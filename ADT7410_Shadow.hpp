@@ -0,0 +1,347 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Shadow.hpp
+ */
+
+#ifndef ADT7410_SHADOW_HPP
+#define ADT7410_SHADOW_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Time.hpp"
+
+/*
+ * Write-through shadow of the ADT7410 register map.
+ * Keeps the last value written to (or read from) every cacheable register so
+ * that field reads and read-modify-write updates do not touch the bus.
+ * TEMPERATURE and Status change on their own and are always read from the
+ * device; all other registers only change through the bus or a reset.
+ * The one exception is OPMODE: the device returns to shutdown after a one-shot
+ * conversion. A Configuration with OPMODE one-shot is shadowed as written for
+ * CONVERSION_TIME, then with OPMODE shutdown, the state it settles in. So a
+ * modify() of another field during the conversion writes one-shot back, which
+ * restarts the conversion rather than aborting it, and setting OPMODE one-shot
+ * after the conversion is never skipped. The time base is ADT7410_now() unless
+ * setClock() replaces it (e.g. with a manual ADT7410_SimClock).
+ *
+ * Only successful transactions update the shadow: a failed read leaves the
+ * slot unknown, a failed write forgets it (the device may or may not have
+ * taken the value), so a later identical write is not skipped. error()
+ * reports the failure of the last access that went to the bus.
+ */
+class ADT7410_Shadow
+{
+public:
+	ADT7410_Shadow(ADT7410_Base &device)
+		: device(device), valid(0), last_error(0), hits(0), misses(0), now_hook(0), now_context(0), one_shot_end(0)
+	{
+		for (int i = 0; i < SLOTS; i++)
+			values[i] = 0;
+	}
+
+	/* Underlying device */
+	ADT7410_Base &getDevice()
+	{
+		return device;
+	}
+
+	/* Time base of the one-shot conversion, ADT7410_now() if now is 0 */
+	void setClock(ADT7410_NowHook now, void *context)
+	{
+		now_hook = now;
+		now_context = context;
+	}
+
+	/* TEMPERATURE and Status are never cached */
+	static bool isVolatile(uint16_t address)
+	{
+		return address == ADT7410_Base::TEMPERATURE::__address
+			|| address == ADT7410_Base::Status::__address;
+	}
+
+	/* Registers that can be served from the shadow */
+	static bool isCacheable(uint16_t address)
+	{
+		return slot(address) >= 0;
+	}
+
+	/* Fill the shadow with the power-on defaults (the dflt constants) */
+	void seedDefaults()
+	{
+		typedef ADT7410_Base B;
+		typedef ADT7410_Base::Configuration C;
+		store(C::__address, B::modify<C::FAULT_QUEUE>(C::FAULT_QUEUE::dflt)
+			.set<C::CT_PIN_POLARITY>(C::CT_PIN_POLARITY::dflt)
+			.set<C::INT_PIN_POLARITY>(C::INT_PIN_POLARITY::dflt)
+			.set<C::INT_CT_MODE>(C::INT_CT_MODE::dflt)
+			.set<C::OPMODE>(C::OPMODE::dflt)
+			.set<C::RESOLUTION>(C::RESOLUTION::dflt)
+			.apply(0));
+		store(B::THIGH::__address, B::THIGH::THIGH_::dflt);
+		store(B::TLOW::__address, B::TLOW::TLOW_::dflt);
+		store(B::TCRIT::__address, B::TCRIT::TCRIT_::dflt);
+		store(B::THYST::__address, B::modify<B::THYST::HYSTERESIS>(B::THYST::HYSTERESIS::dflt)
+			.set<B::THYST::unused_0>(B::THYST::unused_0::dflt)
+			.apply(0));
+		/* ID has no complete default (REVISION_ID), it stays unknown until read */
+	}
+
+	/* Fill the shadow from the device, Configuration through ID in one block read; returns 0 or the error */
+	int load()
+	{
+		const uint16_t first = ADT7410_Base::Configuration::__address;
+		uint8_t buffer[ADT7410_Base::ID::__address - first + 1];
+		misses++;
+		last_error = device.tryReadBlock(first, buffer, sizeof(buffer));
+		if (last_error)
+			return last_error;
+		for (int i = 0; i < SLOTS; i++)
+		{
+			uint16_t offset = slotAddress(i) - first;
+			if (width(slotAddress(i)) == 16)
+				store(slotAddress(i), uint16_t((buffer[offset] << 8) | buffer[offset + 1]));
+			else
+				store(slotAddress(i), buffer[offset]);
+		}
+		return 0;
+	}
+
+	/* Reset the device and reseed the shadow with the power-on defaults */
+	void reset()
+	{
+		uint8_t valid_id = valid & (1u << slot(ADT7410_Base::ID::__address));
+		last_error = device.trySetRESET();
+		valid = valid_id;
+		if (!last_error)
+			seedDefaults();
+	}
+
+	/* Forget all shadowed values */
+	void invalidate()
+	{
+		valid = 0;
+	}
+
+	/* Forget the shadowed value of one register */
+	void invalidate(uint16_t address)
+	{
+		int i = slot(address);
+		if (i >= 0)
+			valid &= uint8_t(~(1u << i));
+	}
+
+	/* Error of the last bus access, 0 if none */
+	int error() const
+	{
+		return last_error;
+	}
+
+	/* Whether a register currently holds a shadowed value */
+	bool isValid(uint16_t address) const
+	{
+		int i = slot(address);
+		return i >= 0 && (valid & (1u << i));
+	}
+
+	/* Read a register, from the shadow where possible */
+	uint16_t read(uint16_t address)
+	{
+		int i = slot(address);
+		if (i >= 0 && (valid & (1u << i)))
+		{
+			if (address == ADT7410_Base::Configuration::__address)
+				settle();
+			hits++;
+			last_error = 0;
+			return values[i];
+		}
+		return fetch(address);
+	}
+
+	/* Write a register and remember the value; returns 0 or the error */
+	int write(uint16_t address, uint16_t value)
+	{
+		last_error = width(address) == 16 ? device.tryWrite16(address, value) : device.tryWrite8(address, uint8_t(value));
+		if (!isCacheable(address))
+			return last_error;
+		if (last_error)
+			invalidate(address);
+		else
+			store(address, value);
+		return last_error;
+	}
+
+	/*
+	 * Replace the bits in mask with the (already positioned) bits of value.
+	 * The register is only written if its content actually changes, and never
+	 * if the current content could not be read.
+	 * Returns true if a write was issued (see error() for its outcome).
+	 */
+	bool modify(uint16_t address, uint16_t mask, uint16_t value)
+	{
+		uint16_t current = read(address);
+		if (last_error)
+			return false;
+		uint16_t next = (current & ~mask) | (value & mask);
+		if (next == current)
+			return false;
+		write(address, next);
+		return true;
+	}
+
+	/* Apply a multi-field update (ADT7410_Base::modify<>) with at most one register write */
+	bool modify(uint16_t address, const ADT7410_Base::Modify &m)
+	{
+		return modify(address, m.getMask(), m.getBits());
+	}
+
+	/* Get field F of a register, from the shadow where possible */
+	template<class F>
+	uint16_t get(uint16_t address)
+	{
+		return ADT7410_Base::get<F>(read(address));
+	}
+
+	/* Set field F of a register, writing only if it changes */
+	template<class F>
+	bool set(uint16_t address, uint16_t value)
+	{
+		return modify(address, ADT7410_Base::modify<F>(value));
+	}
+
+	/* Shadow lookups served without bus access */
+	uint32_t getHits() const
+	{
+		return hits;
+	}
+
+	/* Shadow lookups that needed a bus read */
+	uint32_t getMisses() const
+	{
+		return misses;
+	}
+
+	void resetCounters()
+	{
+		hits = 0;
+		misses = 0;
+	}
+
+	/* Same accessors as ADT7410_Base, served from the shadow */
+	uint16_t getTEMPERATURE() { return device.getTEMPERATURE(); }
+	uint8_t getStatus() { return device.getStatus(); }
+	uint8_t getConfiguration() { return uint8_t(read(ADT7410_Base::Configuration::__address)); }
+	int setConfiguration(uint8_t value) { return write(ADT7410_Base::Configuration::__address, value); }
+	uint16_t getTHIGH() { return read(ADT7410_Base::THIGH::__address); }
+	int setTHIGH(uint16_t value) { return write(ADT7410_Base::THIGH::__address, value); }
+	uint16_t getTLOW() { return read(ADT7410_Base::TLOW::__address); }
+	int setTLOW(uint16_t value) { return write(ADT7410_Base::TLOW::__address, value); }
+	uint16_t getTCRIT() { return read(ADT7410_Base::TCRIT::__address); }
+	int setTCRIT(uint16_t value) { return write(ADT7410_Base::TCRIT::__address, value); }
+	uint8_t getTHYST() { return uint8_t(read(ADT7410_Base::THYST::__address)); }
+	int setTHYST(uint8_t value) { return write(ADT7410_Base::THYST::__address, value); }
+	uint8_t getID() { return uint8_t(read(ADT7410_Base::ID::__address)); }
+
+protected:
+	enum { SLOTS = 6 };
+
+	/* Shadow slot of a register, -1 if it is not cacheable */
+	static int slot(uint16_t address)
+	{
+		switch (address)
+		{
+		case ADT7410_Base::Configuration::__address: return 0;
+		case ADT7410_Base::THIGH::__address: return 1;
+		case ADT7410_Base::TLOW::__address: return 2;
+		case ADT7410_Base::TCRIT::__address: return 3;
+		case ADT7410_Base::THYST::__address: return 4;
+		case ADT7410_Base::ID::__address: return 5;
+		default: return -1;
+		}
+	}
+
+	/* Slot address, in address order */
+	static uint16_t slotAddress(int slot)
+	{
+		static const uint16_t addresses[SLOTS] =
+		{
+			ADT7410_Base::Configuration::__address,
+			ADT7410_Base::THIGH::__address,
+			ADT7410_Base::TLOW::__address,
+			ADT7410_Base::TCRIT::__address,
+			ADT7410_Base::THYST::__address,
+			ADT7410_Base::ID::__address,
+		};
+		return addresses[slot];
+	}
+
+	static uint8_t width(uint16_t address)
+	{
+		return address == ADT7410_Base::TEMPERATURE::__address
+			|| address == ADT7410_Base::THIGH::__address
+			|| address == ADT7410_Base::TLOW::__address
+			|| address == ADT7410_Base::TCRIT::__address ? 16 : 8;
+	}
+
+	uint64_t now()
+	{
+		return now_hook ? now_hook(now_context) : ADT7410_now();
+	}
+
+	void store(uint16_t address, uint16_t value)
+	{
+		typedef ADT7410_Base::Configuration C;
+		int i = slot(address);
+		/* A one-shot read back is already converting; assume it just started, the later end is the safe one */
+		if (address == C::__address && ADT7410_Base::get<C::OPMODE>(value) == C::OPMODE::ONE_SHOT)
+			one_shot_end = now() + ADT7410_Base::CONVERSION_TIME;
+		values[i] = value;
+		valid |= uint8_t(1u << i);
+	}
+
+	/* Shadow a one-shot Configuration with OPMODE shutdown once its conversion is over */
+	void settle()
+	{
+		typedef ADT7410_Base::Configuration C;
+		uint16_t &value = values[slot(C::__address)];
+		if (ADT7410_Base::get<C::OPMODE>(value) == C::OPMODE::ONE_SHOT && now() >= one_shot_end)
+			value = ADT7410_Base::set<C::OPMODE>(value, C::OPMODE::SHUTDOWB);
+	}
+
+	/* Read from the bus, shadowing the value if the register is cacheable and the read succeeded */
+	uint16_t fetch(uint16_t address)
+	{
+		uint16_t value = 0;
+		if (width(address) == 16)
+			last_error = device.tryRead16(address, value);
+		else
+		{
+			uint8_t byte = 0;
+			last_error = device.tryRead8(address, byte);
+			value = byte;
+		}
+		if (!isCacheable(address))
+			return value;
+		misses++;
+		if (!last_error)
+			store(address, value);
+		return value;
+	}
+
+	ADT7410_Base &device;
+	uint16_t values[SLOTS];
+	uint8_t valid;
+	int last_error;
+	uint32_t hits;
+	uint32_t misses;
+	ADT7410_NowHook now_hook;
+	void *now_context;
+	uint64_t one_shot_end;
+};
+
+#endif /* ADT7410_SHADOW_HPP */
@@ -0,0 +1,229 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_SharedTable.cpp
+ */
+
+#include "ADT7410_SharedTable.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char TABLE_MAGIC[8] = { 'A', 'D', 'T', '7', '4', '1', '0', 'T' };
+static const uint32_t TABLE_VERSION = 1;
+
+/* Header: magic, version, entries, entry size; padded to one cache line */
+static const size_t TABLE_HEADER = ADT7410_CACHE_LINE;
+
+/* Reader attempts before giving up on an entry that keeps changing */
+static const int READ_ATTEMPTS = 1000;
+
+static void put32(uint8_t *p, uint32_t value)
+{
+	memcpy(p, &value, sizeof(value));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+ADT7410_SharedTable::ADT7410_SharedTable()
+	: fd(-1), writable(false), memory(0), length(0), devices(0), entries(0)
+{
+}
+
+ADT7410_SharedTable::~ADT7410_SharedTable()
+{
+	close();
+}
+
+bool ADT7410_SharedTable::create(uint32_t devices, const char *path)
+{
+	close();
+	int fd = path ? ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+		: memfd_create("adt7410-table", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0)
+		return false;
+	size_t length = TABLE_HEADER + size_t(devices) * sizeof(Entry);
+	if (ftruncate(fd, off_t(length)) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	if (!path)
+		fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+
+	/* The file is zero-filled, so every entry starts out never written */
+	void *map = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		::close(fd);
+		return false;
+	}
+	uint8_t *header = static_cast<uint8_t *>(map);
+	memcpy(header, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+	put32(header + 8, TABLE_VERSION);
+	put32(header + 12, devices);
+	put32(header + 16, uint32_t(sizeof(Entry)));
+
+	this->fd = fd;
+	this->writable = true;
+	this->memory = header;
+	this->length = length;
+	this->devices = devices;
+	this->entries = reinterpret_cast<Entry *>(header + TABLE_HEADER);
+	return true;
+}
+
+bool ADT7410_SharedTable::open(const char *path)
+{
+	close();
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	if (!map(fd, false))
+	{
+		::close(fd);
+		return false;
+	}
+	return true;
+}
+
+bool ADT7410_SharedTable::open(int fd)
+{
+	close();
+	int copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (copy < 0)
+		return false;
+	if (!map(copy, false))
+	{
+		::close(copy);
+		return false;
+	}
+	return true;
+}
+
+bool ADT7410_SharedTable::map(int fd, bool writable)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0 || size_t(st.st_size) < TABLE_HEADER)
+		return false;
+	size_t length = size_t(st.st_size);
+	void *map = mmap(0, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		return false;
+	uint8_t *header = static_cast<uint8_t *>(map);
+	uint32_t devices = get32(header + 12);
+	if (memcmp(header, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0 || get32(header + 8) != TABLE_VERSION
+		|| get32(header + 16) != sizeof(Entry) || TABLE_HEADER + size_t(devices) * sizeof(Entry) > length)
+	{
+		munmap(map, length);
+		return false;
+	}
+	this->fd = fd;
+	this->writable = writable;
+	this->memory = header;
+	this->length = length;
+	this->devices = devices;
+	this->entries = reinterpret_cast<Entry *>(header + TABLE_HEADER);
+	return true;
+}
+
+void ADT7410_SharedTable::close()
+{
+	if (memory)
+		munmap(memory, length);
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+	writable = false;
+	memory = 0;
+	length = 0;
+	devices = 0;
+	entries = 0;
+}
+
+void ADT7410_SharedTable::publish(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp)
+{
+	if (!writable || device >= devices)
+		return;
+	Entry &e = entries[device];
+	uint32_t sequence = e.sequence;
+
+	/* Odd: readers retry until the entry is complete again */
+	e.sequence = sequence + 1;
+	ADT7410_fence();
+	e.value = (uint32_t(snapshot.temperature) << 16) | (uint32_t(snapshot.status) << 8) | snapshot.configuration;
+	e.time_low = uint32_t(timestamp);
+	e.time_high = uint32_t(timestamp >> 32);
+	e.updates = e.updates + 1;
+	ADT7410_storeRelease(&e.sequence, sequence + 2);
+}
+
+void ADT7410_SharedTable::publish(const ADT7410_Sample &sample)
+{
+	ADT7410_Base::Snapshot snapshot;
+	snapshot.temperature = sample.temperature;
+	snapshot.status = sample.status;
+	snapshot.configuration = sample.configuration;
+	publish(sample.device, snapshot, sample.timestamp);
+}
+
+void ADT7410_SharedTable::sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp)
+{
+	publish(device, snapshot, timestamp);
+}
+
+bool ADT7410_SharedTable::read(uint16_t device, ADT7410_Sample &sample) const
+{
+	if (device >= devices)
+		return false;
+	const Entry &e = entries[device];
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++)
+	{
+		uint32_t before = ADT7410_loadAcquire(&e.sequence);
+		if (!before)
+			return false;
+		if (before & 1)
+			continue;
+		uint32_t value = e.value;
+		uint32_t time_low = e.time_low;
+		uint32_t time_high = e.time_high;
+		ADT7410_fence();
+		if (e.sequence != before)
+			continue;
+
+		sample.timestamp = (uint64_t(time_high) << 32) | time_low;
+		sample.device = device;
+		sample.temperature = uint16_t(value >> 16);
+		sample.status = uint8_t(value >> 8);
+		sample.configuration = uint8_t(value);
+		return true;
+	}
+	return false;
+}
+
+size_t ADT7410_SharedTable::readAll(ADT7410_Sample *samples, size_t max) const
+{
+	size_t n = 0;
+	for (uint32_t i = 0; i < devices && n < max; i++)
+		if (read(uint16_t(i), samples[n]))
+			n++;
+	return n;
+}
+
+uint32_t ADT7410_SharedTable::getUpdates(uint16_t device) const
+{
+	return device < devices ? ADT7410_loadAcquire(&entries[device].updates) : 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_SharedTable.hpp
+ */
+
+#ifndef ADT7410_SHAREDTABLE_HPP
+#define ADT7410_SHAREDTABLE_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Acquisition.hpp"
+#include "ADT7410_Atomic.hpp"
+#include "ADT7410_Ring.hpp"
+
+/*
+ * Latest sample of every device in shared memory, written by the acquisition
+ * process and read by any number of others without syscalls or bus traffic.
+ *
+ * The table lives in a memfd (hand the descriptor to readers over a Unix socket
+ * or let them open /proc/<pid>/fd/<fd>) or in a file on a tmpfs such as /dev/shm.
+ * Each entry has a cache line of its own and a sequence counter: the writer makes
+ * it odd while updating, readers copy the entry and retry if the counter was odd
+ * or changed meanwhile. Writers never wait; a reader only retries while the very
+ * entry it reads is being written.
+ *
+ * Each entry must have a single writer at a time, which is what an
+ * ADT7410_Acquisition guarantees when the table is its sink.
+ */
+class ADT7410_SharedTable : public ADT7410_SampleSink
+{
+public:
+	ADT7410_SharedTable();
+	~ADT7410_SharedTable();
+
+	/* Create a table for devices entries, in a new memfd or (path given) a file; maps it writable */
+	bool create(uint32_t devices, const char *path = 0);
+
+	/* Map an existing table read-only */
+	bool open(const char *path);
+	bool open(int fd);
+
+	void close();
+
+	/* Descriptor of the table, -1 if none is open */
+	int getFd() const
+	{
+		return fd;
+	}
+
+	uint32_t size() const
+	{
+		return devices;
+	}
+
+	bool isWritable() const
+	{
+		return writable;
+	}
+
+	/* Publish a sample of a device, ignored for devices beyond the table or a read-only mapping */
+	void publish(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp);
+	void publish(const ADT7410_Sample &sample);
+
+	/* ADT7410_SampleSink */
+	void sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp);
+
+	/* Consistent copy of an entry; false if it was never published or kept changing */
+	bool read(uint16_t device, ADT7410_Sample &sample) const;
+
+	/* Copy all published entries, returns their number */
+	size_t readAll(ADT7410_Sample *samples, size_t max) const;
+
+	/* Number of times an entry was published */
+	uint32_t getUpdates(uint16_t device) const;
+
+private:
+	ADT7410_SharedTable(const ADT7410_SharedTable &);
+	ADT7410_SharedTable &operator=(const ADT7410_SharedTable &);
+
+	/* All fields are 32-bit words so readers and the writer only exchange whole words */
+	struct Entry
+	{
+		volatile uint32_t sequence;   // odd while being written, 0 if never written
+		volatile uint32_t value;      // temperature << 16 | status << 8 | configuration
+		volatile uint32_t time_low;
+		volatile uint32_t time_high;
+		volatile uint32_t updates;
+		uint8_t padding[ADT7410_CACHE_LINE - 5 * sizeof(uint32_t)];
+	};
+
+	bool map(int fd, bool writable);
+
+	int fd;
+	bool writable;
+	uint8_t *memory;
+	size_t length;
+	uint32_t devices;
+	Entry *entries;
+};
+
+#endif /* ADT7410_SHAREDTABLE_HPP */
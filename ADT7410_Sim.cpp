@@ -0,0 +1,300 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sim.cpp
+ */
+
+#include "ADT7410_Sim.hpp"
+#include "ADT7410_Alarm.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <cerrno>
+
+typedef ADT7410_Base::Configuration C;
+
+/* Catch up at most this many conversions after a long idle period, older ones cannot matter */
+static const uint64_t MAX_CATCH_UP = 16;
+
+static ADT7410_SimClock monotonic;
+
+uint64_t ADT7410_SimClock::now() const
+{
+	return manual ? time : ADT7410_now();
+}
+
+void ADT7410_SimClock::sleep(uint64_t duration)
+{
+	if (manual)
+		time += duration;
+	else
+		ADT7410_sleep(duration);
+}
+
+ADT7410_Sim::ADT7410_Sim(ADT7410_SimClock *clock, uint32_t seed)
+	: clock(clock ? clock : &monotonic), random(seed), error_threshold(0), latency(0), temperature(25 * 128),
+	  last_error(0), transactions(0), nacks(0), conversions(0)
+{
+	powerOn(this->clock->now());
+	busy_until = 0;
+}
+
+int32_t ADT7410_Sim::temperatureAt(uint64_t)
+{
+	return temperature;
+}
+
+void ADT7410_Sim::setErrorRate(double rate)
+{
+	if (rate <= 0)
+		error_threshold = 0;
+	else if (rate >= 1)
+		error_threshold = 0xFFFFFFFFu;
+	else
+		error_threshold = uint32_t(rate * 4294967296.0);
+}
+
+void ADT7410_Sim::powerOn(uint64_t now)
+{
+	temperature_value = TEMPERATURE::TEMPERATURE_::dflt;
+	configuration = 0;
+	thigh = THIGH::THIGH_::dflt;
+	tlow = TLOW::TLOW_::dflt;
+	tcrit = TCRIT::TCRIT_::dflt;
+	thyst = THYST::HYSTERESIS::dflt;
+	ready = false;
+	flags = 0;
+	active = 0;
+	faults_low = faults_high = faults_crit = 0;
+	interrupt = false;
+	busy_until = now + RESET_TIME;
+	last_update = now;
+	schedule(now);
+}
+
+void ADT7410_Sim::schedule(uint64_t now)
+{
+	switch (get<C::OPMODE>(configuration))
+	{
+	case C::OPMODE::CONTINOUS_CONVERSIO:
+		next_conversion = now + CONVERSION_TIME;
+		period = CONVERSION_TIME;
+		break;
+	case C::OPMODE::ONE_SPS:
+		next_conversion = now + ONE_SPS_CONVERSION_TIME;
+		period = ONE_SPS_PERIOD;
+		break;
+	case C::OPMODE::ONE_SHOT:
+		next_conversion = now + CONVERSION_TIME;
+		period = 0;
+		break;
+	default:
+		next_conversion = 0;
+		period = 0;
+		break;
+	}
+}
+
+void ADT7410_Sim::update(uint64_t now)
+{
+	last_update = now;
+	while (next_conversion && next_conversion <= now)
+	{
+		if (period && now - next_conversion > MAX_CATCH_UP * period)
+		{
+			uint64_t skip = (now - next_conversion) / period - MAX_CATCH_UP;
+			next_conversion += skip * period;
+			conversions += skip;
+		}
+		convert(next_conversion);
+		next_conversion = period ? next_conversion + period : 0;
+
+		/* A one-shot conversion ends in shutdown, Configuration reads back OPMODE 11 */
+		if (!period && get<C::OPMODE>(configuration) == C::OPMODE::ONE_SHOT)
+			configuration = uint8_t(set<C::OPMODE>(configuration, C::OPMODE::SHUTDOWB));
+	}
+}
+
+void ADT7410_Sim::convert(uint64_t time)
+{
+	int32_t t = temperatureAt(time);
+	if (t > 32767)
+		t = 32767;
+	if (t < -32768)
+		t = -32768;
+
+	/* 13-bit mode resolves 1/16 °C, i.e. multiples of 8 in 1/128 °C */
+	bool res16 = get<C::RESOLUTION>(configuration) == C::RESOLUTION::RES_16_BIT;
+	int16_t converted = int16_t(res16 ? t : (t & ~7));
+	bool comparator = get<C::INT_CT_MODE>(configuration) == C::INT_CT_MODE::COMPARATOR_MODE;
+	uint8_t queue = uint8_t(get<C::FAULT_QUEUE>(configuration) + 1);
+	int32_t hysteresis = int32_t(get<THYST::HYSTERESIS>(thyst)) * 128;
+
+	ADT7410_AlarmLogic::evaluate(converted, int16_t(tlow), int16_t(thigh), int16_t(tcrit), hysteresis, queue, comparator,
+		active, flags, interrupt, faults_low, faults_high, faults_crit);
+
+	temperature_value = uint16_t(converted);
+	if (!res16 && comparator)
+		temperature_value = uint16_t(temperature_value | ADT7410_AlarmLogic::temperatureFlags(active));
+	ready = true;
+	conversions++;
+}
+
+void ADT7410_Sim::configure(uint8_t value, uint64_t now)
+{
+	uint8_t old_mode = uint8_t(get<C::OPMODE>(configuration));
+	uint8_t mode = uint8_t(get<C::OPMODE>(value));
+	configuration = value;
+
+	/* Writing the one-shot bits resets nRDY and starts over, as does any mode change */
+	if (mode == C::OPMODE::ONE_SHOT || mode == C::OPMODE::ONE_SPS)
+	{
+		ready = false;
+		schedule(now);
+	}
+	else if (mode != old_mode)
+		schedule(now);
+}
+
+uint8_t ADT7410_Sim::status() const
+{
+	return uint8_t((ready ? 0 : Status::nRDY::mask) | flags);
+}
+
+uint8_t ADT7410_Sim::byte(uint16_t address) const
+{
+	switch (address)
+	{
+	case 0: return uint8_t(temperature_value >> 8);
+	case 1: return uint8_t(temperature_value);
+	case 2: return status();
+	case 3: return configuration;
+	case 4: return uint8_t(thigh >> 8);
+	case 5: return uint8_t(thigh);
+	case 6: return uint8_t(tlow >> 8);
+	case 7: return uint8_t(tlow);
+	case 8: return uint8_t(tcrit >> 8);
+	case 9: return uint8_t(tcrit);
+	case 10: return thyst;
+	case 11: return ID_VALUE;
+	default: return 0;
+	}
+}
+
+void ADT7410_Sim::setByte(uint16_t address, uint8_t value)
+{
+	switch (address)
+	{
+	case 3: configure(value, last_update); break;
+	case 4: thigh = uint16_t((thigh & 0x00FF) | (value << 8)); break;
+	case 5: thigh = uint16_t((thigh & 0xFF00) | value); break;
+	case 6: tlow = uint16_t((tlow & 0x00FF) | (value << 8)); break;
+	case 7: tlow = uint16_t((tlow & 0xFF00) | value); break;
+	case 8: tcrit = uint16_t((tcrit & 0x00FF) | (value << 8)); break;
+	case 9: tcrit = uint16_t((tcrit & 0xFF00) | value); break;
+	case 10: thyst = value; break;
+	default: break;  // read-only or unused
+	}
+}
+
+void ADT7410_Sim::afterRead(uint16_t address, uint16_t length)
+{
+	for (uint16_t a = address; a < address + length; a++)
+	{
+		if (a == TEMPERATURE::__address)
+			ready = false;
+		else if (a == Status::__address)
+		{
+			flags = 0;
+			interrupt = false;
+		}
+	}
+}
+
+bool ADT7410_Sim::begin()
+{
+	transactions++;
+	if (latency)
+		clock->sleep(latency);
+	uint64_t now = clock->now();
+	update(now);
+
+	random = random * 1664525u + 1013904223u;
+	if (now < busy_until || (error_threshold && random < error_threshold))
+	{
+		nacks++;
+		last_error = ENXIO;
+		return false;
+	}
+	last_error = 0;
+	return true;
+}
+
+uint8_t ADT7410_Sim::read8(uint16_t address, uint16_t)
+{
+	if (!begin())
+		return 0;
+	uint8_t value = byte(address);
+	afterRead(address, 1);
+	return value;
+}
+
+uint16_t ADT7410_Sim::read16(uint16_t address, uint16_t)
+{
+	if (!begin())
+		return 0;
+	uint16_t value = uint16_t((byte(address) << 8) | byte(address + 1));
+	afterRead(address, 2);
+	return value;
+}
+
+void ADT7410_Sim::readBlock(uint16_t address, uint8_t *buffer, uint16_t length)
+{
+	if (!begin())
+	{
+		for (uint16_t i = 0; i < length; i++)
+			buffer[i] = 0;
+		return;
+	}
+	/* All bytes are taken before the read side effects apply, Status still shows nRDY of the conversion */
+	for (uint16_t i = 0; i < length; i++)
+		buffer[i] = byte(address + i);
+	afterRead(address, length);
+}
+
+void ADT7410_Sim::write(uint16_t address, uint8_t value, uint16_t n)
+{
+	if (!begin())
+		return;
+	if (address == RESET::__address)
+		powerOn(last_update);
+	else if (n)
+		setByte(address, value);
+}
+
+void ADT7410_Sim::write(uint16_t address, uint16_t value, uint16_t)
+{
+	if (!begin())
+		return;
+	setByte(address, uint8_t(value >> 8));
+	setByte(address + 1, uint8_t(value));
+}
+
+bool ADT7410_Sim::getINT()
+{
+	update(clock->now());
+	bool level = get<C::INT_CT_MODE>(configuration) == C::INT_CT_MODE::COMPARATOR_MODE
+		? (active & (ADT7410_AlarmLogic::TLOW | ADT7410_AlarmLogic::THIGH)) != 0 : interrupt;
+	return get<C::INT_PIN_POLARITY>(configuration) == C::INT_PIN_POLARITY::ACTIVE_HIGH ? level : !level;
+}
+
+bool ADT7410_Sim::getCT()
+{
+	update(clock->now());
+	bool level = (active & ADT7410_AlarmLogic::TCRIT) != 0;
+	return get<C::CT_PIN_POLARITY>(configuration) == C::CT_PIN_POLARITY::ACTIVE_HIGH ? level : !level;
+}
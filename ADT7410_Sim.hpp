@@ -0,0 +1,184 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sim.hpp
+ */
+
+#ifndef ADT7410_SIM_HPP
+#define ADT7410_SIM_HPP
+
+#include "ADT7410.hpp"
+
+/* Time base of simulated devices: the monotonic clock, or a manually advanced one for deterministic runs */
+class ADT7410_SimClock
+{
+public:
+	ADT7410_SimClock(bool manual = false)
+		: manual(manual), time(0)
+	{
+	}
+
+	bool isManual() const
+	{
+		return manual;
+	}
+
+	/* Current time (nanoseconds) */
+	uint64_t now() const;
+
+	/* Advance a manual clock */
+	void advance(uint64_t duration)
+	{
+		time += duration;
+	}
+
+	void set(uint64_t time)
+	{
+		this->time = time;
+	}
+
+	/* Let duration pass: advance a manual clock, sleep otherwise */
+	void sleep(uint64_t duration);
+
+	/* ADT7410_NowHook on the clock passed as context */
+	static uint64_t nowHook(void *clock)
+	{
+		return static_cast<ADT7410_SimClock *>(clock)->now();
+	}
+
+	/* ADT7410_SleepHook on the clock passed as context */
+	static void sleepHook(uint64_t duration, void *clock)
+	{
+		static_cast<ADT7410_SimClock *>(clock)->sleep(duration);
+	}
+
+private:
+	bool manual;
+	uint64_t time;
+};
+
+/*
+ * In-process ADT7410 behind read8/read16/write, for load and latency testing without hardware.
+ *
+ * Modelled: the register map at 0, 2, 3, 4, 6, 8, 10, 11 and the RESET command (47);
+ * conversion times per OPMODE (240 ms continuous and one-shot, 60 ms every second
+ * in 1 SPS); the return to shutdown after a one-shot conversion; nRDY, reset by a TEMPERATURE read or a write of the one-shot bits; the
+ * TLOW/THIGH/TCRIT logic with FAULT_QUEUE and THYST hysteresis in interrupt and
+ * comparator mode, including the flag bits of the 13-bit TEMPERATURE word and the
+ * INT/CT pins; Status flags clearing on read; the RESET_TIME after RESET during which
+ * every transaction is NACKed. Timings are the ADT7410_Registers TIMING constants.
+ * Injected: a fixed latency per transaction and a random NACK rate.
+ *
+ * Devices are updated lazily when accessed, so thousands of them cost nothing
+ * while idle. A NACKed transaction has no side effects and reports ENXIO through
+ * error(), like the i2c-dev transport.
+ */
+class ADT7410_Sim : public ADT7410_Base
+{
+public:
+	/* Content of the ID register (MANUFACTURER_ID 11001, revision 3) */
+	static const uint8_t ID_VALUE = 0xCB;
+
+	/* clock defaults to a shared monotonic clock */
+	ADT7410_Sim(ADT7410_SimClock *clock = 0, uint32_t seed = 1);
+
+	/* Temperature the device converts, 1/128 °C */
+	void setTemperature(int32_t temperature)
+	{
+		this->temperature = temperature;
+	}
+
+	/* Temperature at a given time, override for a varying temperature */
+	virtual int32_t temperatureAt(uint64_t time);
+
+	/* Latency added to every transaction (nanoseconds); advances a manual clock, sleeps otherwise */
+	void setLatency(uint64_t latency)
+	{
+		this->latency = latency;
+	}
+
+	/* Probability of a transaction being NACKed, 0 to 1 */
+	void setErrorRate(double rate);
+
+	/* INT and CT pin levels, taking the configured polarities into account */
+	bool getINT();
+	bool getCT();
+
+	uint64_t getTransactions() const
+	{
+		return transactions;
+	}
+
+	uint64_t getNacks() const
+	{
+		return nacks;
+	}
+
+	uint64_t getConversions() const
+	{
+		return conversions;
+	}
+
+	int error()
+	{
+		return last_error;
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n=8);
+	void write(uint16_t address, uint8_t value, uint16_t n=8);
+	uint16_t read16(uint16_t address, uint16_t n=16);
+	void write(uint16_t address, uint16_t value, uint16_t n=16);
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length);
+
+private:
+	/* Start a transaction: latency, NACK injection, catching up on conversions */
+	bool begin();
+	void powerOn(uint64_t now);
+	void update(uint64_t now);
+	void convert(uint64_t time);
+	void schedule(uint64_t now);
+	uint8_t status() const;
+	uint8_t byte(uint16_t address) const;
+	void setByte(uint16_t address, uint8_t value);
+	void afterRead(uint16_t address, uint16_t length);
+	void configure(uint8_t value, uint64_t now);
+
+	ADT7410_SimClock *clock;
+	uint32_t random;
+	uint32_t error_threshold;
+	uint64_t latency;
+	int32_t temperature;
+
+	/* Registers */
+	uint16_t temperature_value;
+	uint8_t configuration;
+	uint16_t thigh;
+	uint16_t tlow;
+	uint16_t tcrit;
+	uint8_t thyst;
+	bool ready;
+	uint8_t flags;        // Status flags, ADT7410_AlarmLogic bits
+	uint8_t active;       // comparator state, with hysteresis
+	uint8_t faults_low;
+	uint8_t faults_high;
+	uint8_t faults_crit;
+	bool interrupt;       // INT in interrupt mode, cleared by a Status read
+
+	/* Conversion timing */
+	uint64_t next_conversion;  // 0 when not converting
+	uint64_t period;           // 0 for a single conversion
+	uint64_t busy_until;       // NACK window after RESET
+	uint64_t last_update;
+
+	int last_error;
+	uint64_t transactions;
+	uint64_t nacks;
+	uint64_t conversions;
+};
+
+#endif /* ADT7410_SIM_HPP */
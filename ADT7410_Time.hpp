@@ -0,0 +1,50 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Time.hpp
+ */
+
+#ifndef ADT7410_TIME_HPP
+#define ADT7410_TIME_HPP
+
+#include <cinttypes>
+#include <cerrno>
+#include <time.h>
+
+/* Monotonic time in nanoseconds */
+inline uint64_t ADT7410_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+/* Sleep until the monotonic time deadline (nanoseconds) */
+inline void ADT7410_sleepUntil(uint64_t deadline)
+{
+	struct timespec ts;
+	ts.tv_sec = time_t(deadline / 1000000000u);
+	ts.tv_nsec = long(deadline % 1000000000u);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR)
+	{
+	}
+}
+
+/* Sleep for a duration (nanoseconds) */
+inline void ADT7410_sleep(uint64_t duration)
+{
+	ADT7410_sleepUntil(ADT7410_now() + duration);
+}
+
+/* Replaceable wait: blocks (or advances a simulated clock) for a duration (nanoseconds); context is passed through */
+typedef void (*ADT7410_SleepHook)(uint64_t duration, void *context);
+
+/* Replaceable clock: current time (nanoseconds) on the time base of context */
+typedef uint64_t (*ADT7410_NowHook)(void *context);
+
+#endif /* ADT7410_TIME_HPP */
@@ -0,0 +1,232 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Window.cpp
+ */
+
+#include "ADT7410_Window.hpp"
+#include "ADT7410_Decode.hpp"
+
+#include <cmath>
+#include <cstring>
+
+typedef ADT7410_Base::Configuration C;
+
+ADT7410_Aggregator::ADT7410_Aggregator(ADT7410_WindowSink &sink, size_t devices, uint64_t window, uint64_t hop, uint32_t capacity)
+	: sink(sink), window(window ? window : 1), hop(hop == window ? 0 : hop), mask(0)
+{
+	Device idle;
+	memset(&idle, 0, sizeof(idle));
+	this->devices.assign(devices, idle);
+
+	if (this->hop)
+	{
+		uint32_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		mask = size - 1;
+		Value none = { 0, 0 };
+		values.assign(devices * size, none);
+		min_queue.assign(devices * size, 0);
+		max_queue.assign(devices * size, 0);
+	}
+}
+
+uint64_t ADT7410_Aggregator::getOverflows() const
+{
+	uint64_t overflows = 0;
+	for (size_t i = 0; i < devices.size(); i++)
+		overflows += devices[i].overflows;
+	return overflows;
+}
+
+int16_t ADT7410_Aggregator::mean(int64_t sum, uint32_t count)
+{
+	return int16_t(floor(double(sum) / count + 0.5));
+}
+
+float ADT7410_Aggregator::rate(int16_t first, uint64_t first_time, int16_t last, uint64_t last_time)
+{
+	if (last_time <= first_time)
+		return 0;
+	return float((double(last) - first) * (1.0 / 128) / (double(last_time - first_time) * 1e-9));
+}
+
+void ADT7410_Aggregator::add(uint16_t device, uint16_t raw, bool res16, uint64_t timestamp)
+{
+	if (device >= devices.size())
+		return;
+	int16_t t = ADT7410_decode(raw, res16);
+	if (hop)
+		addSliding(devices[device], device, t, timestamp);
+	else
+		addTumbling(devices[device], device, t, timestamp);
+}
+
+void ADT7410_Aggregator::add(const ADT7410_Sample &sample)
+{
+	add(sample.device, sample.temperature,
+		ADT7410_Base::get<C::RESOLUTION>(sample.configuration) == C::RESOLUTION::RES_16_BIT, sample.timestamp);
+}
+
+void ADT7410_Aggregator::add(const ADT7410_Sample *samples, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		add(samples[i]);
+}
+
+void ADT7410_Aggregator::sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp)
+{
+	add(device, snapshot.temperature,
+		ADT7410_Base::get<C::RESOLUTION>(snapshot.configuration) == C::RESOLUTION::RES_16_BIT, timestamp);
+}
+
+void ADT7410_Aggregator::flush(uint64_t now)
+{
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		Device &d = devices[i];
+		if (!d.started)
+			continue;
+		if (hop)
+			advance(d, uint16_t(i), now);
+		else if (now >= d.end && d.count)
+		{
+			emitTumbling(d, uint16_t(i));
+			d.count = 0;
+			d.end = now - now % window + window;
+		}
+	}
+}
+
+void ADT7410_Aggregator::addTumbling(Device &d, uint16_t device, int16_t t, uint64_t timestamp)
+{
+	if (!d.started || timestamp >= d.end)
+	{
+		if (d.started && d.count)
+			emitTumbling(d, device);
+		d.started = true;
+		d.count = 0;
+		d.end = timestamp - timestamp % window + window;
+	}
+
+	if (!d.count)
+	{
+		d.min = d.max = d.first = t;
+		d.first_time = timestamp;
+		d.sum = 0;
+	}
+	if (t < d.min)
+		d.min = t;
+	if (t > d.max)
+		d.max = t;
+	d.sum += t;
+	d.last = t;
+	d.last_time = timestamp;
+	d.count++;
+}
+
+void ADT7410_Aggregator::emitTumbling(Device &d, uint16_t device)
+{
+	ADT7410_WindowSummary s;
+	s.device = device;
+	s.begin = d.end - window;
+	s.end = d.end;
+	s.count = d.count;
+	s.min = d.min;
+	s.max = d.max;
+	s.mean = mean(d.sum, d.count);
+	s.last = d.last;
+	s.rate = rate(d.first, d.first_time, d.last, d.last_time);
+	sink.summary(s);
+}
+
+void ADT7410_Aggregator::advance(Device &d, uint16_t device, uint64_t time)
+{
+	while (time >= d.end)
+	{
+		expire(d, device, d.end > window ? d.end - window : 0);
+		if (d.head == d.tail)
+		{
+			/* Nothing left to report, skip the empty windows at once */
+			d.end = time - time % hop + hop;
+			break;
+		}
+		emitSliding(d, device);
+		d.end += hop;
+	}
+}
+
+void ADT7410_Aggregator::addSliding(Device &d, uint16_t device, int16_t t, uint64_t timestamp)
+{
+	if (!d.started)
+	{
+		d.started = true;
+		d.end = timestamp - timestamp % hop + hop;
+	}
+	else
+		advance(d, device, timestamp);
+
+	if (d.tail - d.head > mask)
+	{
+		evict(d, device);
+		d.overflows++;
+	}
+
+	const size_t base = size_t(device) * (mask + 1);
+	Value &v = values[base + (d.tail & mask)];
+	v.timestamp = timestamp;
+	v.temperature = t;
+	d.sum += t;
+
+	/* Monotonic queues: the front is the minimum (maximum) of the window */
+	while (d.min_tail != d.min_head && values[base + (min_queue[base + ((d.min_tail - 1) & mask)] & mask)].temperature >= t)
+		d.min_tail--;
+	min_queue[base + (d.min_tail++ & mask)] = d.tail;
+	while (d.max_tail != d.max_head && values[base + (max_queue[base + ((d.max_tail - 1) & mask)] & mask)].temperature <= t)
+		d.max_tail--;
+	max_queue[base + (d.max_tail++ & mask)] = d.tail;
+
+	d.tail++;
+}
+
+void ADT7410_Aggregator::evict(Device &d, uint16_t device)
+{
+	const size_t base = size_t(device) * (mask + 1);
+	d.sum -= values[base + (d.head & mask)].temperature;
+	if (d.min_head != d.min_tail && min_queue[base + (d.min_head & mask)] == d.head)
+		d.min_head++;
+	if (d.max_head != d.max_tail && max_queue[base + (d.max_head & mask)] == d.head)
+		d.max_head++;
+	d.head++;
+}
+
+void ADT7410_Aggregator::expire(Device &d, uint16_t device, uint64_t begin)
+{
+	const size_t base = size_t(device) * (mask + 1);
+	while (d.head != d.tail && values[base + (d.head & mask)].timestamp < begin)
+		evict(d, device);
+}
+
+void ADT7410_Aggregator::emitSliding(Device &d, uint16_t device)
+{
+	const size_t base = size_t(device) * (mask + 1);
+	const Value &first = values[base + (d.head & mask)];
+	const Value &last = values[base + ((d.tail - 1) & mask)];
+	ADT7410_WindowSummary s;
+	s.device = device;
+	s.begin = d.end > window ? d.end - window : 0;
+	s.end = d.end;
+	s.count = d.tail - d.head;
+	s.min = values[base + (min_queue[base + (d.min_head & mask)] & mask)].temperature;
+	s.max = values[base + (max_queue[base + (d.max_head & mask)] & mask)].temperature;
+	s.mean = mean(d.sum, s.count);
+	s.last = last.temperature;
+	s.rate = rate(first.temperature, first.timestamp, last.temperature, last.timestamp);
+	sink.summary(s);
+}
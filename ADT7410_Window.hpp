@@ -0,0 +1,143 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Window.hpp
+ */
+
+#ifndef ADT7410_WINDOW_HPP
+#define ADT7410_WINDOW_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Acquisition.hpp"
+#include "ADT7410_Ring.hpp"
+
+#include <vector>
+
+/* Summary of one device over one window; temperatures in 1/128 °C */
+struct ADT7410_WindowSummary
+{
+	uint16_t device;
+	uint64_t begin;   // window start, inclusive (nanoseconds)
+	uint64_t end;     // window end, exclusive
+	uint32_t count;   // samples in the window
+	int16_t min;
+	int16_t max;
+	int16_t mean;     // rounded to nearest
+	int16_t last;
+	float rate;       // °C per second between the first and last sample, 0 for a single sample
+};
+
+/* Receives window summaries */
+class ADT7410_WindowSink
+{
+public:
+	virtual ~ADT7410_WindowSink()
+	{
+	}
+
+	virtual void summary(const ADT7410_WindowSummary &summary) = 0;
+};
+
+/*
+ * Incremental per-device aggregation of raw samples into window summaries.
+ *
+ * Tumbling windows (hop 0 or equal to the window) are aligned to multiples of the
+ * window length and keep only running min/max/sum/first/last per device.
+ * Sliding windows of length window are summarised every hop nanoseconds; each
+ * device keeps its samples in a ring of capacity entries plus monotonic min/max
+ * queues, so every update is amortised O(1). A device seeing more than capacity
+ * samples within one window loses the oldest (counted by getOverflows()).
+ *
+ * A window is emitted when the first sample past its end arrives, or by flush().
+ * All state is allocated up front; devices are the sample's device ids, below the
+ * number given to the constructor, others are ignored.
+ * As an ADT7410_SampleSink it can hang directly off an ADT7410_Acquisition: every
+ * device is only fed by its bus's worker, so the devices of different buses may be
+ * updated concurrently; the window sink must then be thread-safe.
+ */
+class ADT7410_Aggregator : public ADT7410_SampleSink
+{
+public:
+	ADT7410_Aggregator(ADT7410_WindowSink &sink, size_t devices, uint64_t window, uint64_t hop = 0, uint32_t capacity = 64);
+
+	bool isSliding() const
+	{
+		return hop != 0;
+	}
+
+	/* Add one sample */
+	void add(uint16_t device, uint16_t raw, bool res16, uint64_t timestamp);
+
+	void add(const ADT7410_Sample &sample);
+	void add(const ADT7410_Sample *samples, size_t n);
+
+	/* ADT7410_SampleSink */
+	void sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t timestamp);
+
+	/* Emit all windows that ended by now, also of devices that got no samples since; not concurrently with add() */
+	void flush(uint64_t now);
+
+	/* Samples lost to full sliding windows */
+	uint64_t getOverflows() const;
+
+private:
+	struct Value
+	{
+		uint64_t timestamp;
+		int16_t temperature;
+	};
+
+	struct Device
+	{
+		uint64_t end;         // end of the current window, the next emission when sliding
+		bool started;
+		int64_t sum;
+		uint64_t overflows;
+		/* Tumbling */
+		uint32_t count;
+		int16_t min;
+		int16_t max;
+		int16_t first;
+		int16_t last;
+		uint64_t first_time;
+		uint64_t last_time;
+		/* Sliding: sequence numbers into the rings */
+		uint32_t head;        // oldest sample
+		uint32_t tail;        // next sample
+		uint32_t min_head;
+		uint32_t min_tail;
+		uint32_t max_head;
+		uint32_t max_tail;
+	};
+
+	void addTumbling(Device &d, uint16_t device, int16_t t, uint64_t timestamp);
+	void addSliding(Device &d, uint16_t device, int16_t t, uint64_t timestamp);
+	void emitTumbling(Device &d, uint16_t device);
+	void emitSliding(Device &d, uint16_t device);
+
+	/* Emit the sliding windows that end by time */
+	void advance(Device &d, uint16_t device, uint64_t time);
+
+	/* Drop the oldest sample, or all older than begin */
+	void evict(Device &d, uint16_t device);
+	void expire(Device &d, uint16_t device, uint64_t begin);
+
+	static int16_t mean(int64_t sum, uint32_t count);
+	static float rate(int16_t first, uint64_t first_time, int16_t last, uint64_t last_time);
+
+	ADT7410_WindowSink &sink;
+	uint64_t window;
+	uint64_t hop;
+	uint32_t mask;                    // ring capacity - 1
+	std::vector<Device> devices;
+	std::vector<Value> values;        // devices × capacity
+	std::vector<uint32_t> min_queue;  // sequence numbers, devices × capacity
+	std::vector<uint32_t> max_queue;
+};
+
+#endif /* ADT7410_WINDOW_HPP */
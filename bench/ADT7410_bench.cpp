@@ -0,0 +1,614 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        bench/ADT7410_bench.cpp
+ */
+
+/*
+ * Benchmark suite, run against the in-process simulator (ADT7410_Sim):
+ *   dispatch.*     cost of a poll through ADT7410_Base against the compile-time transport: time,
+ *                  counter ticks (rdtsc, cntvct_el0) and code size of the two polling loops
+ *   sample.*       transactions and CPU time per sample, one access per register against block reads
+ *   dump.*         transactions for a full register dump, per register against ADT7410_RegisterMap
+ *   decode.*       batch TEMPERATURE decoder throughput
+ *   acquisition.*  end-to-end samples per second through ADT7410_Acquisition, N devices per bus
+ * With --i2c, sample.* is repeated on a real or i2c-stub bus (i2cdev.*), counting the transfer ioctls
+ * (I2C_RDWR, or I2C_SMBUS on SMBus-only adapters such as i2c-stub).
+ * On the simulator every transaction stands for one such ioctl on i2c-dev.
+ *
+ * Output is one JSON object per line: {"name":...,"value":...,"unit":...,"better":...,"gate":...}
+ * for results, {"meta":...,"value":...} for the environment. Every timed result is the best
+ * of REPEAT runs.
+ *
+ * With --baseline the results are compared against a previous output (bench/baseline.jsonl is
+ * the checked-in reference) and the exit status is 1 if a gated result regressed. Only results
+ * that hold across machines are gated: "exact" ones, the transaction counts, must match, and
+ * ratios of two timings taken side by side (dispatch.speedup) may not get worse by more than
+ * the tolerance. Absolute times, rates and code sizes depend on the machine and compiler and
+ * are listed for information only. If the environment (compiler, decode kernel, CPUs, mode)
+ * differs from the baseline's, a warning is printed and only the exact results are gated.
+ *
+ * Build (from bench/):
+ *   g++ -O2 -I.. -o ADT7410_bench ADT7410_bench.cpp ../ADT7410_Decode.cpp ../ADT7410_Sim.cpp \
+ *       ../ADT7410_Alarm.cpp ../ADT7410_Acquisition.cpp ../ADT7410_Descriptor.cpp \
+ *       ../ADT7410_RegisterMap.cpp ../ADT7410_LinuxI2C.cpp -lpthread
+ *   (add -mavx2 for the AVX2 decode kernel)
+ * Run:
+ *   ./ADT7410_bench > results.jsonl
+ *   ./ADT7410_bench --baseline baseline.jsonl [--tolerance 0.5] [--quick] [--i2c /dev/i2c-N [--address 0x48]]
+ * Exit status: 0, 1 if a gated result regressed, 2 on a usage error or an unreadable baseline.
+ */
+
+#include "ADT7410.hpp"
+#include "ADT7410_Acquisition.hpp"
+#include "ADT7410_Decode.hpp"
+#include "ADT7410_LinuxI2C.hpp"
+#include "ADT7410_RegisterMap.hpp"
+#include "ADT7410_Sim.hpp"
+#include "ADT7410_Time.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <elf.h>
+#include <unistd.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define HAVE_CYCLES 1
+#elif defined(__aarch64__)
+static inline uint64_t cntvct()
+{
+	uint64_t value;
+	__asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(value));
+	return value;
+}
+#define CYCLES() cntvct()
+#define HAVE_CYCLES 1
+#else
+#define CYCLES() 0
+#define HAVE_CYCLES 0
+#endif
+
+/* Best of this many repetitions for every timed result */
+static const int REPEAT = 5;
+
+enum Better { LOWER, HIGHER, EXACT };
+
+static const char *BETTER_NAMES[] = { "lower", "higher", "exact" };
+
+struct Result
+{
+	std::string name;
+	double value;
+	std::string unit;
+	Better better;
+	bool gate;      // compared against the baseline, otherwise informational
+};
+
+struct Meta
+{
+	std::string name;
+	std::string value;
+};
+
+static std::vector<Result> results;
+static std::vector<Meta> metas;
+static bool quick = false;
+
+/* Exact results are always gated, others only if gate is set */
+static void report(const char *name, double value, const char *unit, Better better, bool gate = false)
+{
+	Result r;
+	r.name = name;
+	r.value = value;
+	r.unit = unit;
+	r.better = better;
+	r.gate = gate || better == EXACT;
+	results.push_back(r);
+	printf("{\"name\":\"%s\",\"value\":%.6g,\"unit\":\"%s\",\"better\":\"%s\",\"gate\":%s}\n",
+		name, value, unit, BETTER_NAMES[better], r.gate ? "true" : "false");
+	fflush(stdout);
+}
+
+static void meta(const char *name, const char *value)
+{
+	Meta m;
+	m.name = name;
+	m.value = value;
+	metas.push_back(m);
+	printf("{\"meta\":\"%s\",\"value\":\"%s\"}\n", name, value);
+}
+
+static volatile uint32_t sink32;
+
+/****************************************************************************************************\
+ *                                             DISPATCH                                             *
+\****************************************************************************************************/
+
+/* Register file shared by both transports */
+struct Memory
+{
+	/* volatile, so the loads stay in the loop like bus accesses would */
+	volatile uint8_t registers[48];
+
+	uint8_t read8(uint16_t address)
+	{
+		return registers[address];
+	}
+
+	uint16_t read16(uint16_t address)
+	{
+		return uint16_t((registers[address] << 8) | registers[address + 1]);
+	}
+
+	void write8(uint16_t address, uint8_t value)
+	{
+		registers[address] = value;
+	}
+
+	void write16(uint16_t address, uint16_t value)
+	{
+		registers[address] = uint8_t(value >> 8);
+		registers[address + 1] = uint8_t(value);
+	}
+};
+
+class VirtualTransport : public ADT7410_Base
+{
+public:
+	Memory memory;
+
+	uint8_t read8(uint16_t address, uint16_t) { return memory.read8(address); }
+	void write(uint16_t address, uint8_t value, uint16_t) { memory.write8(address, value); }
+	uint16_t read16(uint16_t address, uint16_t) { return memory.read16(address); }
+	void write(uint16_t address, uint16_t value, uint16_t) { memory.write16(address, value); }
+};
+
+class StaticTransport : public ADT7410_Device<StaticTransport>
+{
+public:
+	Memory memory;
+
+	uint8_t read8(uint16_t address, uint16_t) { return memory.read8(address); }
+	void write(uint16_t address, uint8_t value, uint16_t) { memory.write8(address, value); }
+	uint16_t read16(uint16_t address, uint16_t) { return memory.read16(address); }
+	void write(uint16_t address, uint16_t value, uint16_t) { memory.write16(address, value); }
+};
+
+/* The hot loop of a poller: temperature and status, through each API */
+__attribute__((noinline)) uint32_t poll_virtual(ADT7410_Base &device, uint32_t n)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < n; i++)
+		sum += device.getTEMPERATURE() + device.getStatus();
+	return sum;
+}
+
+__attribute__((noinline)) uint32_t poll_static(StaticTransport &device, uint32_t n)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < n; i++)
+		sum += device.getTEMPERATURE() + device.getStatus();
+	return sum;
+}
+
+/* Size of the first function symbol of this executable whose name contains name, 0 if not found */
+static uint64_t symbolSize(const char *name)
+{
+	FILE *file = fopen("/proc/self/exe", "rb");
+	if (!file)
+		return 0;
+	std::vector<char> image;
+	char buffer[65536];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		image.insert(image.end(), buffer, buffer + n);
+	fclose(file);
+	if (image.size() < sizeof(Elf64_Ehdr) || memcmp(&image[0], ELFMAG, SELFMAG) != 0 || image[EI_CLASS] != ELFCLASS64)
+		return 0;
+
+	const Elf64_Ehdr *header = reinterpret_cast<const Elf64_Ehdr *>(&image[0]);
+	if (header->e_shoff + uint64_t(header->e_shnum) * sizeof(Elf64_Shdr) > image.size())
+		return 0;
+	const Elf64_Shdr *sections = reinterpret_cast<const Elf64_Shdr *>(&image[0] + header->e_shoff);
+	for (int i = 0; i < header->e_shnum; i++)
+	{
+		if (sections[i].sh_type != SHT_SYMTAB || sections[i].sh_link >= header->e_shnum)
+			continue;
+		const Elf64_Shdr &strings = sections[sections[i].sh_link];
+		if (sections[i].sh_offset + sections[i].sh_size > image.size() || strings.sh_offset + strings.sh_size > image.size())
+			return 0;
+		const Elf64_Sym *symbols = reinterpret_cast<const Elf64_Sym *>(&image[0] + sections[i].sh_offset);
+		size_t count = sections[i].sh_size / sizeof(Elf64_Sym);
+		for (size_t j = 0; j < count; j++)
+		{
+			if (ELF64_ST_TYPE(symbols[j].st_info) != STT_FUNC || symbols[j].st_name >= strings.sh_size)
+				continue;
+			if (strstr(&image[0] + strings.sh_offset + symbols[j].st_name, name))
+				return symbols[j].st_size;
+		}
+	}
+	return 0;
+}
+
+static void benchDispatch()
+{
+	const uint32_t iterations = quick ? 5000000 : 50000000;
+	VirtualTransport v;
+	StaticTransport s;
+	for (int i = 0; i < 48; i++)
+		v.memory.registers[i] = s.memory.registers[i] = uint8_t(i);
+
+	/* Through a pointer the compiler cannot devirtualize */
+	ADT7410_Base *volatile device = &v;
+	double best_virtual = 1e30, best_static = 1e30;
+	double cycles_virtual = 1e30, cycles_static = 1e30;
+	for (int r = 0; r < REPEAT; r++)
+	{
+		uint64_t begin = ADT7410_now();
+		uint64_t cycles = CYCLES();
+		sink32 = poll_virtual(*device, iterations);
+		double ticks = double(CYCLES() - cycles) / iterations;
+		double elapsed = double(ADT7410_now() - begin) / iterations;
+		if (elapsed < best_virtual)
+			best_virtual = elapsed;
+		if (ticks < cycles_virtual)
+			cycles_virtual = ticks;
+
+		begin = ADT7410_now();
+		cycles = CYCLES();
+		sink32 = poll_static(s, iterations);
+		ticks = double(CYCLES() - cycles) / iterations;
+		elapsed = double(ADT7410_now() - begin) / iterations;
+		if (elapsed < best_static)
+			best_static = elapsed;
+		if (ticks < cycles_static)
+			cycles_static = ticks;
+	}
+	report("dispatch.virtual", best_virtual, "ns/poll", LOWER);
+	report("dispatch.static", best_static, "ns/poll", LOWER);
+
+	/* Both loops ran on the same machine in turn, so their ratio carries over to others */
+	report("dispatch.speedup", best_virtual / best_static, "x", HIGHER, true);
+
+	/* Reference counter ticks: TSC cycles on x86, generic timer ticks on AArch64 */
+	if (HAVE_CYCLES)
+	{
+		report("dispatch.virtual.cycles", cycles_virtual, "cycles/poll", LOWER);
+		report("dispatch.static.cycles", cycles_static, "cycles/poll", LOWER);
+	}
+
+	/* Code size of the polling loops, from the symbol table (0 in a stripped binary, not reported) */
+	uint64_t size_virtual = symbolSize("poll_virtual");
+	uint64_t size_static = symbolSize("poll_static");
+	if (size_virtual && size_static)
+	{
+		report("dispatch.virtual.size", double(size_virtual), "bytes", LOWER);
+		report("dispatch.static.size", double(size_static), "bytes", LOWER);
+	}
+}
+
+/****************************************************************************************************\
+ *                                       TRANSACTIONS PER SAMPLE                                    *
+\****************************************************************************************************/
+
+/* One sample as three register accesses */
+static uint32_t sampleSingle(ADT7410_Base &device)
+{
+	return uint32_t(device.getTEMPERATURE()) + device.getStatus() + device.getConfiguration();
+}
+
+/* One sample as one block read */
+static uint32_t sampleBurst(ADT7410_Base &device)
+{
+	ADT7410_Base::Snapshot snapshot = device.readSnapshot();
+	return uint32_t(snapshot.temperature) + snapshot.status + snapshot.configuration;
+}
+
+/* Transactions and nanoseconds per sample, from the getTransactions() counter of the device */
+template<class Device>
+static void measureSamples(Device &device, uint32_t (*sample)(ADT7410_Base &), uint32_t samples,
+	double &transactions, double &time)
+{
+	time = 1e30;
+	for (int r = 0; r < REPEAT; r++)
+	{
+		uint64_t before = device.getTransactions();
+		uint64_t begin = ADT7410_now();
+		uint32_t sum = 0;
+		for (uint32_t i = 0; i < samples; i++)
+			sum += sample(device);
+		double elapsed = double(ADT7410_now() - begin) / samples;
+		sink32 = sum;
+		transactions = double(device.getTransactions() - before) / samples;
+		if (elapsed < time)
+			time = elapsed;
+	}
+}
+
+static void benchSamples()
+{
+	const uint32_t samples = quick ? 100000 : 1000000;
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock);
+	sim.setTemperature(25 * 128);
+
+	double transactions, time;
+	measureSamples(sim, sampleSingle, samples, transactions, time);
+	report("sample.single.transactions", transactions, "transactions/sample", EXACT);
+	report("sample.single.time", time, "ns/sample", LOWER);
+	measureSamples(sim, sampleBurst, samples, transactions, time);
+	report("sample.burst.transactions", transactions, "transactions/sample", EXACT);
+	report("sample.burst.time", time, "ns/sample", LOWER);
+
+	/* Full dump: every readable register on its own, and planned block reads */
+	uint64_t before = sim.getTransactions();
+	uint32_t sum = 0;
+	for (size_t i = 0; i < ADT7410_registerCount; i++)
+	{
+		const ADT7410_RegisterDescriptor &reg = ADT7410_registers[i];
+		if (reg.width == 16)
+			sum += sim.read16(reg.address);
+		else if (reg.width == 8)
+			sum += sim.read8(reg.address);
+	}
+	sink32 = sum;
+	report("dump.single.transactions", double(sim.getTransactions() - before), "transactions/dump", EXACT);
+
+	before = sim.getTransactions();
+	ADT7410_RegisterMap map;
+	map.read(sim, ADT7410_RegisterMap::readable());
+	report("dump.burst.transactions", double(sim.getTransactions() - before), "transactions/dump", EXACT);
+}
+
+static void benchI2C(const char *bus, uint8_t address)
+{
+	const uint32_t samples = quick ? 100 : 1000;
+	ADT7410_LinuxI2C device(bus, address);
+	if (!device.isOpen())
+	{
+		fprintf(stderr, "cannot open %s\n", bus);
+		return;
+	}
+	double transactions, time;
+	measureSamples(device, sampleSingle, samples, transactions, time);
+	report("i2cdev.single.syscalls", transactions, "ioctls/sample", EXACT);
+	report("i2cdev.single.time", time / 1000, "us/sample", LOWER);
+	measureSamples(device, sampleBurst, samples, transactions, time);
+	report("i2cdev.burst.syscalls", transactions, "ioctls/sample", EXACT);
+	report("i2cdev.burst.time", time / 1000, "us/sample", LOWER);
+	if (device.error())
+		fprintf(stderr, "%s: %s\n", bus, strerror(device.error()));
+}
+
+/****************************************************************************************************\
+ *                                              DECODE                                              *
+\****************************************************************************************************/
+
+static volatile int16_t sink16;
+
+static void benchDecode()
+{
+	const size_t n = 1 << 16;
+	const int rounds = quick ? 200 : 2000;
+	std::vector<uint16_t> raw(n);
+	std::vector<int16_t> fixed(n);
+	std::vector<uint8_t> flags(n);
+	uint32_t seed = 1;
+	for (size_t i = 0; i < n; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		raw[i] = uint16_t(seed >> 16);
+	}
+
+	for (int res16 = 0; res16 < 2; res16++)
+	{
+		for (int with_flags = 0; with_flags < 2; with_flags++)
+		{
+			uint8_t *f = with_flags ? &flags[0] : 0;
+			double best = 1e30;
+			for (int r = 0; r < REPEAT; r++)
+			{
+				uint64_t begin = ADT7410_now();
+				for (int i = 0; i < rounds; i++)
+					ADT7410_decode(&raw[0], &fixed[0], n, res16 != 0, f);
+				double elapsed = double(ADT7410_now() - begin);
+				sink16 = fixed[n - 1];
+				if (elapsed < best)
+					best = elapsed;
+			}
+			char name[64];
+			snprintf(name, sizeof(name), "decode.%s%s", res16 ? "16bit" : "13bit", with_flags ? ".flags" : "");
+			report(name, double(n) * rounds / best * 1e3, "Msamples/s", HIGHER);
+		}
+	}
+}
+
+/****************************************************************************************************\
+ *                                           ACQUISITION                                            *
+\****************************************************************************************************/
+
+class NullSink : public ADT7410_SampleSink
+{
+public:
+	void sample(uint16_t, const ADT7410_Base::Snapshot &snapshot, uint64_t)
+	{
+		sink32 = snapshot.temperature;
+	}
+};
+
+static void benchAcquisition(int buses, int devices)
+{
+	const uint64_t duration = quick ? 100000000u : 500000000u;
+	double best = 0;
+	for (int r = 0; r < REPEAT; r++)
+	{
+		NullSink sink;
+		ADT7410_Acquisition acquisition(sink);
+		std::vector<ADT7410_Sim *> sims;
+		for (int b = 0; b < buses; b++)
+		{
+			int bus = acquisition.addBus(0);
+			for (int d = 0; d < devices; d++)
+			{
+				sims.push_back(new ADT7410_Sim(0, uint32_t(sims.size() + 1)));
+				acquisition.addDevice(bus, *sims.back());
+			}
+		}
+		uint64_t begin = ADT7410_now();
+		acquisition.start();
+		ADT7410_sleep(duration);
+		acquisition.stop();
+		double elapsed = double(ADT7410_now() - begin) * 1e-9;
+		uint64_t samples = 0;
+		for (int b = 0; b < buses; b++)
+			samples += acquisition.getBusStats(b).samples;
+		for (size_t i = 0; i < sims.size(); i++)
+			delete sims[i];
+		double rate = double(samples) / elapsed;
+		if (rate > best)
+			best = rate;
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "acquisition.b%d_d%d", buses, devices);
+	report(name, best, "samples/s", HIGHER);
+}
+
+/****************************************************************************************************\
+ *                                             BASELINE                                             *
+\****************************************************************************************************/
+
+/* Whether the baseline was taken in the environment of this run; warns about every difference */
+static bool sameEnvironment(FILE *file)
+{
+	bool same = true;
+	char line[512];
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[128], value[256];
+		if (sscanf(line, "{\"meta\":\"%127[^\"]\",\"value\":\"%255[^\"]\"", name, value) != 2)
+			continue;
+		for (size_t i = 0; i < metas.size(); i++)
+		{
+			if (metas[i].name == name && metas[i].value != value)
+			{
+				fprintf(stderr, "warning: baseline %s is \"%s\", this run \"%s\"\n", name, value, metas[i].value.c_str());
+				same = false;
+			}
+		}
+	}
+	rewind(file);
+	return same;
+}
+
+/* Compare against a previous output, returns the number of regressions (-1 if the baseline cannot be read) */
+static int compare(const char *path, double tolerance)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "cannot open baseline %s\n", path);
+		return -1;
+	}
+	bool same = sameEnvironment(file);
+	if (!same)
+		fprintf(stderr, "warning: different environment, only exact results are gated\n");
+
+	int regressions = 0;
+	char line[512];
+	fprintf(stderr, "%-32s %14s %14s %9s\n", "result", "baseline", "current", "change");
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[128];
+		double value;
+		if (sscanf(line, "{\"name\":\"%127[^\"]\",\"value\":%lf", name, &value) != 2)
+			continue;
+		const Result *current = 0;
+		for (size_t i = 0; i < results.size(); i++)
+			if (results[i].name == name)
+				current = &results[i];
+		if (!current)
+			continue;
+
+		double change = value != 0 ? (current->value - value) / value : 0;
+		bool gated = current->gate && (same || current->better == EXACT);
+		bool regressed = false;
+		switch (current->better)
+		{
+		case LOWER:
+			regressed = change > tolerance;
+			break;
+		case HIGHER:
+			regressed = change < -tolerance;
+			break;
+		case EXACT:
+			regressed = current->value != value;
+			break;
+		}
+		regressed = regressed && gated;
+		if (regressed)
+			regressions++;
+		fprintf(stderr, "%-32s %14.6g %14.6g %+8.1f%%  %s\n", name, value, current->value, change * 100,
+			regressed ? "REGRESSION" : gated ? "ok" : "info");
+	}
+	fclose(file);
+	return regressions;
+}
+
+int main(int argc, char **argv)
+{
+	const char *baseline = 0;
+	const char *bus = 0;
+	uint8_t address = 0x48;
+	double tolerance = 0.5;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--quick"))
+			quick = true;
+		else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+			baseline = argv[++i];
+		else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+			tolerance = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--i2c") && i + 1 < argc)
+			bus = argv[++i];
+		else if (!strcmp(argv[i], "--address") && i + 1 < argc)
+			address = uint8_t(strtoul(argv[++i], 0, 0));
+		else
+		{
+			fprintf(stderr, "usage: %s [--quick] [--baseline FILE] [--tolerance FRACTION] [--i2c BUS [--address ADDR]]\n",
+				argv[0]);
+			return 2;
+		}
+	}
+
+	char cpus[16];
+	snprintf(cpus, sizeof(cpus), "%ld", sysconf(_SC_NPROCESSORS_ONLN));
+	meta("compiler", __VERSION__);
+	meta("decode_kernel", ADT7410_decodeKernel());
+	meta("cpus", cpus);
+	meta("mode", quick ? "quick" : "full");
+
+	benchDispatch();
+	benchSamples();
+	if (bus)
+		benchI2C(bus, address);
+	benchDecode();
+	benchAcquisition(1, 1);
+	benchAcquisition(1, 16);
+	benchAcquisition(1, 128);
+	benchAcquisition(4, 32);
+
+	if (!baseline)
+		return 0;
+	int regressions = compare(baseline, tolerance);
+	return regressions < 0 ? 2 : regressions ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Alarm_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Alarm.hpp"
+#include "ADT7410_Sim.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+static const int STEPS = 300;
+
+/* Fed every conversion result, the table must show the device's Status, INT and CT; returns the mismatches */
+static int compareWithDevice(uint8_t configuration, uint32_t seed)
+{
+	const uint16_t thigh = 30 * 128, tlow = 20 * 128, tcrit = 35 * 128;
+	const uint8_t thyst = 2;
+	bool res16 = B::get<C::RESOLUTION>(configuration) == C::RESOLUTION::RES_16_BIT;
+
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, seed);
+	sim.setTHIGH(thigh);
+	sim.setTLOW(tlow);
+	sim.setTCRIT(tcrit);
+	sim.setTHYST(thyst);
+	sim.setConfiguration(configuration);
+	ADT7410_AlarmTable table(1);
+	table.configure(0, configuration, thigh, tlow, tcrit, thyst);
+
+	/* A random walk across all three setpoints */
+	int mismatches = 0;
+	int32_t temperature = 25 * 128;
+	uint32_t random = seed;
+	for (int step = 0; step < STEPS; step++)
+	{
+		random = random * 1664525u + 1013904223u;
+		temperature += int32_t(random >> 24) - 128;
+		if (temperature < 15 * 128 || temperature > 40 * 128)
+			temperature = 25 * 128;
+		sim.setTemperature(temperature);
+		clock.advance(B::CONVERSION_TIME);
+		uint16_t raw = sim.getTEMPERATURE();
+		table.update(&raw, 1, res16);
+		if (sim.getINT() != table.getINT(0) || sim.getCT() != table.getCT(0))
+			mismatches++;
+		if (step % 5 == 4 && (sim.getStatus() & ADT7410_AlarmLogic::ALL) != table.readStatus(0))
+			mismatches++;
+	}
+	return mismatches;
+}
+
+void testAlarm()
+{
+	/* Every mode, fault queue, polarity and resolution */
+	int mismatches = 0;
+	for (uint16_t c = 0; c < 0x100; c++)
+		if (B::get<C::OPMODE>(c) == C::OPMODE::CONTINOUS_CONVERSIO)
+			mismatches += compareWithDevice(uint8_t(c), c + 1);
+	CHECK(mismatches == 0);
+
+	/* The single-step logic: THIGH with a fault queue of 2 and 1 °C hysteresis, comparator mode */
+	uint8_t active = 0, flags = 0, faults_low = 0, faults_high = 0, faults_crit = 0;
+	bool interrupt = false;
+	const int16_t tlow = 10 * 128, thigh = 30 * 128, tcrit = 60 * 128;
+	ADT7410_AlarmLogic::evaluate(31 * 128, tlow, thigh, tcrit, 128, 2, true, active, flags, interrupt, faults_low, faults_high, faults_crit);
+	CHECK(active == 0 && faults_high == 1);
+	ADT7410_AlarmLogic::evaluate(31 * 128, tlow, thigh, tcrit, 128, 2, true, active, flags, interrupt, faults_low, faults_high, faults_crit);
+	CHECK(active == ADT7410_AlarmLogic::THIGH && (flags & ADT7410_AlarmLogic::THIGH));
+	CHECK(ADT7410_AlarmLogic::temperatureFlags(active) == B::TEMPERATURE::THIGHFLAG_LSB1::mask);
+	ADT7410_AlarmLogic::evaluate(29 * 128 + 64, tlow, thigh, tcrit, 128, 2, true, active, flags, interrupt, faults_low, faults_high, faults_crit);
+	CHECK(active == ADT7410_AlarmLogic::THIGH);
+	ADT7410_AlarmLogic::evaluate(28 * 128, tlow, thigh, tcrit, 128, 2, true, active, flags, interrupt, faults_low, faults_high, faults_crit);
+	CHECK(active == 0 && !(flags & ADT7410_AlarmLogic::THIGH));
+
+	/* Samples address devices by index; ones beyond the table are skipped, resizing keeps the others */
+	ADT7410_AlarmTable table(2);
+	uint8_t interrupt_mode = 0;
+	table.configure(0, interrupt_mode, 30 * 128, 10 * 128, 60 * 128, 0);
+	table.configure(1, interrupt_mode, 30 * 128, 10 * 128, 60 * 128, 0);
+	ADT7410_Sample samples[3] = {
+		ADT7410_makeSample(1, uint16_t(40 * 128), 1),
+		ADT7410_makeSample(0, uint16_t(20 * 128), 1),
+		ADT7410_makeSample(7, uint16_t(40 * 128), 1),
+	};
+	CHECK(table.update(samples, 3) == 1);
+	CHECK(table.getStatus(1) == ADT7410_AlarmLogic::THIGH && table.getStatus(0) == 0);
+	table.resize(3);
+	CHECK(table.size() == 3 && table.getStatus(1) == ADT7410_AlarmLogic::THIGH);
+	CHECK(table.readStatus(1) == ADT7410_AlarmLogic::THIGH && table.getStatus(1) == 0);
+	table.clear(1);
+	CHECK(table.getActive(1) == 0);
+}
@@ -0,0 +1,142 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Async_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Async.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+#include <poll.h>
+#include <pthread.h>
+#include <vector>
+
+typedef ADT7410_Base B;
+
+/* Completion target that records its results and can be waited for */
+class Completions : public ADT7410_AsyncCallback
+{
+public:
+	Completions()
+		: blocking(0), count(0), blocking_error(0), blocking_value(0xFF)
+	{
+		pthread_mutex_init(&lock, 0);
+		pthread_cond_init(&changed, 0);
+	}
+
+	~Completions()
+	{
+		pthread_cond_destroy(&changed);
+		pthread_mutex_destroy(&lock);
+	}
+
+	void complete(const ADT7410_AsyncResult &result)
+	{
+		/* A blocking access from the callback, on whatever thread runs it */
+		int e = 0;
+		uint8_t value = 0xFF;
+		if (blocking)
+			e = blocking->tryRead8(B::ID::__address, value);
+		pthread_mutex_lock(&lock);
+		results.push_back(result);
+		blocking_error = e;
+		blocking_value = value;
+		count++;
+		pthread_cond_signal(&changed);
+		pthread_mutex_unlock(&lock);
+	}
+
+	void waitFor(size_t n)
+	{
+		pthread_mutex_lock(&lock);
+		while (count < n)
+			pthread_cond_wait(&changed, &lock);
+		pthread_mutex_unlock(&lock);
+	}
+
+	ADT7410_Base *blocking;
+	std::vector<ADT7410_AsyncResult> results;
+	size_t count;
+	int blocking_error;
+	uint8_t blocking_value;
+
+private:
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+};
+
+void testAsync()
+{
+	ADT7410_Sim sim(0, 1);
+	sim.setTemperature(25 * 128);
+	ADT7410_AsyncBus bus(ADT7410_AsyncBus::CALLBACK);
+	CHECK(bus.start());
+	CHECK(!bus.isWorker());
+	ADT7410_AsyncDevice device(bus, sim);
+
+	/* Every snapshot is one block read: the register reads are queued together */
+	bool single = true;
+	for (int i = 0; i < 200; i++)
+	{
+		ADT7410_AsyncBus::Stats before = bus.getStats();
+		uint64_t transactions = sim.getTransactions();
+		B::Snapshot snapshot;
+		single = single && device.tryReadSnapshot(snapshot) == 0
+			&& bus.getStats().transactions == before.transactions + 1
+			&& bus.getStats().coalesced == before.coalesced + 2
+			&& sim.getTransactions() == transactions + 1;
+	}
+	CHECK(single);
+
+	/* Single accesses and writes */
+	CHECK(device.tryWrite16(B::THIGH::__address, 0x1234) == 0);
+	uint16_t thigh = 0;
+	CHECK(device.tryRead16(B::THIGH::__address, thigh) == 0 && thigh == 0x1234);
+	uint8_t block[12];
+	CHECK(device.tryReadBlock(0, block, sizeof(block)) == 0);
+	CHECK(block[4] == 0x12 && block[5] == 0x34 && block[11] == ADT7410_Sim::ID_VALUE);
+
+	/* A failed block read is all zeros */
+	sim.setErrorRate(1);
+	CHECK(device.tryReadBlock(2, block, 4) == ENXIO);
+	CHECK(!block[0] && !block[1] && !block[2] && !block[3]);
+	sim.setErrorRate(0);
+
+	/* Blocking from a callback on the worker fails with EDEADLK instead of hanging */
+	Completions on_worker;
+	on_worker.blocking = &device;
+	CHECK(bus.submitRead(sim, B::ID::__address, &on_worker) != 0);
+	on_worker.waitFor(1);
+	CHECK(on_worker.blocking_error == EDEADLK && on_worker.blocking_value == 0xFF);
+	CHECK(on_worker.results[0].value == ADT7410_Sim::ID_VALUE);
+	bus.stop();
+
+	/* After stop() nothing is queued */
+	CHECK(bus.submitRead(sim, B::ID::__address, &on_worker) == 0);
+	CHECK(device.tryRead16(B::THIGH::__address, thigh) == ENODEV);
+
+	/* EVENTFD: callbacks run in dispatch(), where blocking accesses work */
+	ADT7410_AsyncBus queued(ADT7410_AsyncBus::EVENTFD);
+	CHECK(queued.start());
+	ADT7410_AsyncDevice queued_device(queued, sim);
+	Completions dispatched;
+	dispatched.blocking = &queued_device;
+	uint32_t id = queued.submitRead(sim, B::TEMPERATURE::__address, &dispatched, &dispatched);
+	CHECK(id != 0);
+	struct pollfd fd = { queued.getEventFd(), POLLIN, 0 };
+	CHECK(poll(&fd, 1, 1000) == 1);
+	size_t runs = 0;
+	while (dispatched.count < 1 && poll(&fd, 1, 1000) == 1)
+		runs += queued.dispatch();
+	CHECK(dispatched.count == 1 && runs == 1);
+	CHECK(dispatched.results[0].id == id && dispatched.results[0].context == &dispatched);
+	CHECK(dispatched.blocking_error == 0 && dispatched.blocking_value == ADT7410_Sim::ID_VALUE);
+	queued.stop();
+}
@@ -0,0 +1,146 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Block_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+/* Register-at-a-time transport on a simulated device, without readBlock(); accesses of one address fail */
+class RegisterTransport : public ADT7410_Device<RegisterTransport>
+{
+public:
+	RegisterTransport(ADT7410_Sim &sim)
+		: sim(sim), failing(0xFFFF), last_error(0), transactions(0)
+	{
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n)
+	{
+		if (!begin(address))
+			return 0;
+		uint8_t value = sim.read8(address, n);
+		last_error = sim.error();
+		return value;
+	}
+
+	uint16_t read16(uint16_t address, uint16_t n)
+	{
+		if (!begin(address))
+			return 0;
+		uint16_t value = sim.read16(address, n);
+		last_error = sim.error();
+		return value;
+	}
+
+	void write(uint16_t address, uint8_t value, uint16_t n)
+	{
+		if (!begin(address))
+			return;
+		sim.write(address, value, n);
+		last_error = sim.error();
+	}
+
+	void write(uint16_t address, uint16_t value, uint16_t n)
+	{
+		if (!begin(address))
+			return;
+		sim.write(address, value, n);
+		last_error = sim.error();
+	}
+
+	int error()
+	{
+		return last_error;
+	}
+
+	ADT7410_Sim &sim;
+	uint16_t failing;
+	int last_error;
+	uint32_t transactions;
+
+private:
+	bool begin(uint16_t address)
+	{
+		transactions++;
+		last_error = address == failing ? EIO : 0;
+		return !last_error;
+	}
+};
+
+void testBlock()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	RegisterTransport transport(sim);
+	sim.setTemperature(25 * 128 + 5);
+	clock.advance(B::CONVERSION_TIME);
+
+	/* Shut down after one conversion, so repeated reads see the same registers */
+	sim.setConfiguration(uint8_t(B::set<C::OPMODE>(0, C::OPMODE::SHUTDOWB)));
+	B::Snapshot snapshot = sim.readSnapshot();
+	CHECK(snapshot.temperature == 0x0C80);
+	CHECK(!(snapshot.status & B::Status::nRDY::mask));
+	CHECK(B::get<C::OPMODE>(snapshot.configuration) == C::OPMODE::SHUTDOWB);
+
+	/* One transaction on the simulator, one per register on the fallback, the same bytes */
+	uint8_t block[12], fallback[12];
+	uint64_t before = sim.getTransactions();
+	sim.readBlock(0, block, sizeof(block));
+	CHECK(sim.getTransactions() == before + 1);
+	CHECK(transport.tryReadBlock(0, fallback, sizeof(fallback)) == 0);
+	CHECK(transport.transactions == 8);
+	CHECK(!memcmp(block, fallback, sizeof(block)));
+	CHECK(block[11] == ADT7410_Sim::ID_VALUE);
+
+	/* An unaligned block reads the odd byte alone */
+	transport.transactions = 0;
+	CHECK(transport.tryReadBlock(5, fallback, 4) == 0);
+	CHECK(transport.transactions == 3);
+	CHECK(!memcmp(block + 5, fallback, 4));
+
+	B::Snapshot fallen = B::Snapshot();
+	CHECK(transport.tryReadSnapshot(fallen) == 0);
+	CHECK(fallen.temperature == snapshot.temperature && fallen.configuration == snapshot.configuration);
+
+	/* The first failure ends the block: its error is returned, not the result of the reads after it */
+	transport.failing = B::Status::__address;
+	transport.transactions = 0;
+	CHECK(transport.tryReadBlock(0, fallback, sizeof(fallback)) == EIO);
+	CHECK(transport.transactions == 2);
+	bool zeroed = true;
+	for (size_t i = 0; i < sizeof(fallback); i++)
+		zeroed = zeroed && !fallback[i];
+	CHECK(zeroed);
+
+	/* A failed snapshot leaves the output alone */
+	B::Snapshot unchanged = fallen;
+	unchanged.status = 0x55;
+	fallen.status = 0x55;
+	CHECK(transport.tryReadSnapshot(fallen) == EIO);
+	CHECK(fallen.status == unchanged.status && fallen.temperature == unchanged.temperature);
+
+	/* Failing on the last register still fails the block */
+	transport.failing = C::__address;
+	CHECK(transport.tryReadSnapshot(fallen) == EIO);
+	transport.failing = 0xFFFF;
+	CHECK(transport.tryReadSnapshot(fallen) == 0 && fallen.configuration == snapshot.configuration);
+
+	/* The simulator NACKs the whole block */
+	sim.setErrorRate(1);
+	CHECK(sim.tryReadBlock(0, block, 4) == ENXIO);
+	CHECK(!block[0] && !block[3]);
+	sim.setErrorRate(0);
+}
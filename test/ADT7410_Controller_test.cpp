@@ -0,0 +1,92 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Controller_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Controller.hpp"
+#include "ADT7410_Sim.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+static const uint64_t SECOND = 1000000000ull;
+
+void testController()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	ADT7410_Shadow shadow(sim);
+	shadow.setClock(ADT7410_SimClock::nowHook, &clock);
+	ADT7410_Controller controller;
+	controller.setDwell(0);
+	uint16_t device = controller.addDevice(controller.addBus(), shadow);
+	CHECK(device == 0 && controller.addDevice(5, shadow) == ADT7410_Controller::INVALID_DEVICE);
+
+	/* The first update configures LEVEL_CONTINUOUS: one read, one write */
+	uint64_t before = sim.getTransactions();
+	CHECK(controller.update(0) == 1);
+	CHECK(sim.getTransactions() - before == 2);
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::CONTINOUS_CONVERSIO);
+	CHECK(B::get<C::RESOLUTION>(sim.getConfiguration()) == C::RESOLUTION::RES_16_BIT);
+	CHECK(controller.getOpmode(device) == C::OPMODE::CONTINOUS_CONVERSIO && controller.getPeriod(device) == B::CONVERSION_TIME);
+
+	/* A steady device is demoted; the shadow already holds 1 SPS, so the stale error of an unrelated transaction is no failure */
+	shadow.write(C::__address, uint16_t(B::modify<C::OPMODE>(C::OPMODE::ONE_SPS).apply(0)));
+	sim.setErrorRate(1);
+	sim.getID();
+	sim.setErrorRate(0);
+	CHECK(sim.error() != 0);
+	controller.observe(device, 25 * 128, 1 * SECOND);
+	controller.observe(device, 25 * 128, 2 * SECOND);
+	before = sim.getTransactions();
+	CHECK(controller.update(2 * SECOND) == 0);
+	CHECK(sim.getTransactions() == before);
+	CHECK(controller.getLevel(device) == ADT7410_Controller::LEVEL_ONE_SPS);
+	ADT7410_Controller::Report report = controller.getReport();
+	CHECK(report.avoided == 1 && report.errors == 0 && report.writes == 1 && report.demotions == 1);
+
+	/* A failed write forgets Configuration only, and is retried by the next update */
+	shadow.read(B::THIGH::__address);
+	sim.setErrorRate(1);
+	CHECK(controller.update(3 * SECOND) == 1);
+	CHECK(controller.getLevel(device) == ADT7410_Controller::LEVEL_ONE_SHOT);
+	CHECK(controller.getReport().errors == 1);
+	CHECK(!shadow.isValid(C::__address) && shadow.isValid(B::THIGH::__address));
+	sim.setErrorRate(0);
+	CHECK(controller.update(4 * SECOND) == 1);
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::SHUTDOWB);
+	CHECK(controller.getOpmode(device) == C::OPMODE::ONE_SHOT);
+	report = controller.getReport();
+	CHECK(report.writes == 2 && report.errors == 1);
+	CHECK(controller.update(5 * SECOND) == 0);
+
+	/* A drifting device is promoted at once */
+	controller.observe(device, 25 * 128, 10 * SECOND);
+	controller.observe(device, 35 * 128, 11 * SECOND);
+	CHECK(controller.getRate(device) >= 0.02);
+	CHECK(controller.update(11 * SECOND) == 1);
+	CHECK(controller.getLevel(device) == ADT7410_Controller::LEVEL_CONTINUOUS);
+	CHECK(controller.getReport().promotions == 1);
+
+	/* Over budget, the slowest-changing device of the bus is demoted */
+	ADT7410_Sim sim0(&clock, 2), sim1(&clock, 3);
+	ADT7410_Shadow shadow0(sim0), shadow1(sim1);
+	ADT7410_Controller budgeted;
+	int bus = budgeted.addBus(budgeted.cost(ADT7410_Controller::LEVEL_CONTINUOUS) + budgeted.cost(ADT7410_Controller::LEVEL_ONE_SPS));
+	uint16_t slow = budgeted.addDevice(bus, shadow0);
+	uint16_t fast = budgeted.addDevice(bus, shadow1);
+	budgeted.observe(fast, 25 * 128, 0);
+	budgeted.observe(fast, 26 * 128, 1 * SECOND);
+	CHECK(budgeted.update(1 * SECOND) == 2);
+	CHECK(budgeted.getLevel(slow) == ADT7410_Controller::LEVEL_ONE_SPS);
+	CHECK(budgeted.getLevel(fast) == ADT7410_Controller::LEVEL_CONTINUOUS);
+	report = budgeted.getReport();
+	CHECK(report.current <= report.baseline && report.saved == report.baseline - report.current);
+}
@@ -0,0 +1,77 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Decode_test.cpp
+ */
+
+/*
+ * The batch kernel against the scalar ADT7410_decode() on every raw word. Only
+ * the kernel selected at compile time is covered; build with -mavx2 (or for ARM)
+ * to run the others.
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Decode.hpp"
+
+#include <vector>
+
+static const size_t WORDS = 0x10000;
+
+/* Decode raw[offset, offset + n) in one batch and compare every output with the scalar path */
+static bool sameAsScalar(const std::vector<uint16_t> &raw, size_t offset, size_t n, bool res16)
+{
+	std::vector<int16_t> out(n + 1, 0x5555);
+	std::vector<float> real(n + 1, -1000);
+	std::vector<uint8_t> flags(n + 1, 0xEE), float_flags(n + 1, 0xEE);
+	ADT7410_decode(&raw[offset], &out[0], n, res16, &flags[0]);
+	ADT7410_decodeFloat(&raw[offset], &real[0], n, res16, &float_flags[0]);
+	for (size_t i = 0; i < n; i++)
+	{
+		uint16_t word = raw[offset + i];
+		uint8_t expected = res16 ? 0 : uint8_t(word & 0x07);
+		if (out[i] != ADT7410_decode(word, res16) || real[i] != ADT7410_decodeFloat(word, res16)
+			|| flags[i] != expected || float_flags[i] != expected)
+			return false;
+	}
+	/* Nothing written past the end */
+	return out[n] == 0x5555 && real[n] == -1000 && flags[n] == 0xEE && float_flags[n] == 0xEE;
+}
+
+void testDecode()
+{
+	CHECK(ADT7410_decodeKernel() != 0);
+
+	/* Datasheet values */
+	CHECK(ADT7410_decode(0x0C80, false) == 25 * 128);
+	CHECK(ADT7410_decode(0x0C87, false) == 25 * 128);
+	CHECK(ADT7410_decode(0xFFF8, false) == -8);
+	CHECK(ADT7410_decode(0xE480, false) == -55 * 128);
+	CHECK(ADT7410_decode(0x4B00, true) == 150 * 128);
+	CHECK(ADT7410_decode(0xFFFF, true) == -1);
+	CHECK(ADT7410_decodeFloat(0x0C88, false) == 25.0625f);
+
+	std::vector<uint16_t> raw(WORDS + 1);
+	for (size_t i = 0; i < WORDS; i++)
+		raw[i] = uint16_t(i);
+	raw[WORDS] = 0x8000;
+
+	/* All words in both resolutions, aligned and unaligned, and the tails of every vector width */
+	CHECK(sameAsScalar(raw, 0, WORDS, false));
+	CHECK(sameAsScalar(raw, 0, WORDS, true));
+	CHECK(sameAsScalar(raw, 1, WORDS, false));
+	CHECK(sameAsScalar(raw, 1, WORDS, true));
+	bool tails = true;
+	for (size_t n = 0; n <= 40; n++)
+		tails = tails && sameAsScalar(raw, 0xFFF0 - n, n, false) && sameAsScalar(raw, 3, n, true);
+	CHECK(tails);
+
+	/* flags may be omitted */
+	int16_t out[3];
+	ADT7410_decode(&raw[0x0C85], out, 3, false);
+	CHECK(out[0] == 25 * 128 && out[2] == 25 * 128);
+}
@@ -0,0 +1,87 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Device_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <vector>
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+/* Compile-time transport forwarding to a simulated device */
+class SimTransport : public ADT7410_Device<SimTransport>
+{
+public:
+	SimTransport(ADT7410_Sim &sim)
+		: sim(sim)
+	{
+	}
+
+	uint8_t read8(uint16_t address, uint16_t n) { return sim.read8(address, n); }
+	void write(uint16_t address, uint8_t value, uint16_t n) { sim.write(address, value, n); }
+	uint16_t read16(uint16_t address, uint16_t n) { return sim.read16(address, n); }
+	void write(uint16_t address, uint16_t value, uint16_t n) { sim.write(address, value, n); }
+	void readBlock(uint16_t address, uint8_t *buffer, uint16_t length) { sim.readBlock(address, buffer, length); }
+	int error() { return sim.error(); }
+
+private:
+	ADT7410_Sim &sim;
+};
+
+/* The same accesses through either API, every result and error() recorded */
+template<class Device>
+static std::vector<int> exercise(Device &device, ADT7410_SimClock &clock)
+{
+	std::vector<int> trace;
+	for (int round = 0; round < 50; round++)
+	{
+		device.setTHIGH(uint16_t(0x1000 + round));
+		trace.push_back(device.error());
+		trace.push_back(device.getTHIGH());
+		trace.push_back(device.error());
+		device.modifyConfiguration(B::modify<C::RESOLUTION>(round & 1).set<C::FAULT_QUEUE>(round & 3));
+		trace.push_back(device.getConfiguration());
+		trace.push_back(device.getTHYST());
+		trace.push_back(device.getID());
+		B::Snapshot snapshot = B::Snapshot();
+		trace.push_back(device.tryReadSnapshot(snapshot));
+		trace.push_back(snapshot.temperature);
+		trace.push_back(snapshot.status);
+		uint16_t temperature = 0;
+		trace.push_back(device.tryRead16(B::TEMPERATURE::__address, temperature));
+		trace.push_back(temperature);
+		trace.push_back(device.tryWrite8(B::THYST::__address, uint8_t(round & 15)));
+		uint8_t block[12] = { 0 };
+		trace.push_back(device.tryReadBlock(0, block, sizeof(block)));
+		for (size_t i = 0; i < sizeof(block); i++)
+			trace.push_back(block[i]);
+		clock.advance(B::CONVERSION_TIME / 3);
+	}
+	return trace;
+}
+
+void testDevice()
+{
+	/* Two simulators with the same seed on separate clocks see the same accesses */
+	ADT7410_SimClock virtual_clock(true), static_clock(true);
+	ADT7410_Sim virtual_sim(&virtual_clock, 5), static_sim(&static_clock, 5);
+	virtual_sim.setErrorRate(0.2);
+	static_sim.setErrorRate(0.2);
+
+	ADT7410_Base &base = virtual_sim;
+	SimTransport transport(static_sim);
+	std::vector<int> through_base = exercise(base, virtual_clock);
+	std::vector<int> through_transport = exercise(transport, static_clock);
+	CHECK(through_base == through_transport);
+	CHECK(virtual_sim.getTransactions() == static_sim.getTransactions());
+	CHECK(virtual_sim.getNacks() == static_sim.getNacks() && static_sim.getNacks() > 0);
+}
@@ -0,0 +1,163 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Events_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Alarm.hpp"
+#include "ADT7410_Events.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <vector>
+
+typedef ADT7410_Base::Configuration C;
+
+/* Line 0 wired to the open-drain INT pins of some simulated devices */
+class WiredLines : public ADT7410_EventFdLines
+{
+public:
+	WiredLines()
+		: ADT7410_EventFdLines(1)
+	{
+	}
+
+	/* Drive the line from the pins, an edge is queued when its level changes */
+	void update()
+	{
+		bool low = false;
+		for (size_t i = 0; i < pins.size(); i++)
+			low = low || !pins[i]->getINT();
+		setLevel(0, low ? 0 : 1);
+	}
+
+	int getLevel(uint32_t line)
+	{
+		update();
+		return ADT7410_EventFdLines::getLevel(line);
+	}
+
+	std::vector<ADT7410_Sim *> pins;
+};
+
+class Received : public ADT7410_SampleSink
+{
+public:
+	void sample(uint16_t device, const ADT7410_Base::Snapshot &snapshot, uint64_t)
+	{
+		devices.push_back(device);
+		snapshots.push_back(snapshot);
+	}
+
+	std::vector<uint16_t> devices;
+	std::vector<ADT7410_Base::Snapshot> snapshots;
+};
+
+void testEvents()
+{
+	/* EventFdLines: edges only on level changes, the eventfd readable while any are pending */
+	ADT7410_EventFdLines plain(2);
+	ADT7410_LineEvent events[8];
+	CHECK(plain.getFd() >= 0);
+	CHECK(plain.getLevel(0) == 1 && plain.getLevel(5) == -1);
+	plain.setLevel(0, 1, 10);
+	CHECK(plain.readEvents(events, 8) == 0);
+	plain.setLevel(0, 0, 20);
+	plain.setLevel(1, 0, 30);
+	plain.setLevel(0, 1, 40);
+	CHECK(plain.readEvents(events, 8) == 3);
+	CHECK(!events[0].rising && events[0].timestamp == 20 && events[1].line == 1 && events[2].rising);
+	CHECK(plain.readEvents(events, 8) == 0);
+
+	/* Pins of opposite polarity cannot share a line */
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim low(&clock, 1), high(&clock, 2);
+	clock.advance(ADT7410_Base::RESET_TIME);
+	high.setConfiguration(uint8_t(ADT7410_Base::set<C::INT_PIN_POLARITY>(0, C::INT_PIN_POLARITY::ACTIVE_HIGH)));
+	Received ignored;
+	ADT7410_AlarmEvents mixed(plain, ignored);
+	uint16_t dl = mixed.addDevice(low);
+	uint16_t dh = mixed.addDevice(high);
+	CHECK(mixed.attach(dl, ADT7410_AlarmEvents::INT, 0));
+	CHECK(!mixed.attach(dh, ADT7410_AlarmEvents::INT, 0));
+	CHECK(mixed.attach(dh, ADT7410_AlarmEvents::CT, 0));
+	CHECK(mixed.attach(dh, ADT7410_AlarmEvents::INT, 1));
+
+	/* Nor can a later Configuration flip one: refused by setConfiguration(), counted and not taken from a snapshot */
+	const uint8_t high_int = high.getConfiguration();
+	const uint8_t both_high = uint8_t(ADT7410_Base::set<C::CT_PIN_POLARITY>(high_int, C::CT_PIN_POLARITY::ACTIVE_HIGH));
+	CHECK(!mixed.setConfiguration(dh, both_high));
+	CHECK(mixed.getStats().conflicts == 1);
+	CHECK(mixed.setConfiguration(dh, 0));
+	CHECK(mixed.setConfiguration(dh, high_int));
+	const uint8_t comparator = uint8_t(ADT7410_Base::set<C::INT_CT_MODE>(0, C::INT_CT_MODE::COMPARATOR_MODE));
+	low.setConfiguration(comparator);
+	CHECK(mixed.setConfiguration(dl, comparator));
+	CHECK(!mixed.setConfiguration(99, 0));
+	high.setConfiguration(both_high);
+	plain.setLevel(0, 0);
+	CHECK(mixed.process() == 2 && ignored.devices.size() == 2);
+	CHECK(mixed.getStats().conflicts == 2);
+	CHECK(!mixed.setConfiguration(dh, both_high));
+	plain.setLevel(0, 1);
+
+	/* Two devices in interrupt mode (INT active low) share line 0, only a exceeds THIGH */
+	ADT7410_Sim a(&clock, 3), b(&clock, 4);
+	clock.advance(ADT7410_Base::RESET_TIME);
+	a.setTHIGH(20 * 128);
+	WiredLines lines;
+	lines.pins.push_back(&a);
+	lines.pins.push_back(&b);
+	Received received;
+	ADT7410_AlarmEvents alarms(lines, received);
+	uint16_t da = alarms.addDevice(a);
+	uint16_t db = alarms.addDevice(b);
+	CHECK(da != ADT7410_AlarmEvents::INVALID_DEVICE && db != ADT7410_AlarmEvents::INVALID_DEVICE);
+	CHECK(alarms.attach(da, ADT7410_AlarmEvents::INT, 0));
+	CHECK(alarms.attach(db, ADT7410_AlarmEvents::INT, 0));
+	CHECK(alarms.sync() == 0);
+
+	/* The first conversion asserts INT: one edge, both devices on the line read once */
+	clock.advance(ADT7410_Base::CONVERSION_TIME);
+	lines.update();
+	CHECK(alarms.process() == 2);
+	CHECK(received.devices.size() == 2);
+	bool flagged = false, quiet = true;
+	for (size_t i = 0; i < received.devices.size(); i++)
+	{
+		uint8_t flags = uint8_t(received.snapshots[i].status & ~ADT7410_Base::Status::nRDY::mask);
+		if (received.devices[i] == da)
+			flagged = (flags & ADT7410_AlarmLogic::THIGH) != 0;
+		else
+			quiet = quiet && flags == 0;
+	}
+	CHECK(flagged);
+	CHECK(quiet);
+
+	/* Reading Status released INT: the release edge is ours and ignored */
+	CHECK(lines.getLevel(0) == 1);
+	CHECK(alarms.process() == 0);
+	ADT7410_AlarmEvents::Stats stats = alarms.getStats();
+	CHECK(stats.edges == 2 && stats.ignored == 1 && stats.reads == 2 && stats.errors == 0 && stats.rereads == 0);
+
+	/* No edges while nothing changes, however many conversions pass */
+	for (int i = 0; i < 10; i++)
+	{
+		clock.advance(ADT7410_Base::CONVERSION_TIME);
+		lines.update();
+		CHECK(alarms.process() == 0);
+	}
+	CHECK(alarms.getStats().reads == 2);
+
+	/* Back below THIGH - THYST, interrupt mode asserts again */
+	a.setTemperature(10 * 128);
+	clock.advance(ADT7410_Base::CONVERSION_TIME);
+	lines.update();
+	CHECK(alarms.process() == 2);
+	CHECK(alarms.getStats().edges == 3);
+}
@@ -0,0 +1,96 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Fields_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Sim.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+/* get/set of field F against the shift found bit by bit, on a spread of raw values */
+template<class F>
+static bool fieldAccess()
+{
+	uint16_t mask = F::mask;
+	int shift = 0;
+	while (!((mask >> shift) & 1))
+		shift++;
+	if (ADT7410_Shift<F::mask>::value != shift)
+		return false;
+	uint16_t largest = uint16_t(mask >> shift);
+	for (uint32_t r = 0; r < 0x10000; r += 0x0F0F)
+	{
+		uint16_t raw = uint16_t(r ^ 0xA5A5);
+		if (B::get<F>(raw) != ((raw & mask) >> shift))
+			return false;
+		for (uint32_t value = 0; value <= largest; value += 1 + largest / 64)
+		{
+			uint16_t written = B::set<F>(raw, uint16_t(value));
+			if (B::get<F>(written) != value || (written & ~mask) != (raw & ~mask))
+				return false;
+		}
+		/* Bits beyond the field are dropped */
+		if ((B::set<F>(raw, uint16_t(largest + 1)) & ~mask) != (raw & ~mask))
+			return false;
+	}
+	return true;
+}
+
+void testFields()
+{
+	CHECK(fieldAccess<B::TEMPERATURE::TLOWFLAG_LSB0>());
+	CHECK(fieldAccess<B::TEMPERATURE::TEMPERATURE_>());
+	CHECK(fieldAccess<B::TEMPERATURE::SIGN>());
+	CHECK(fieldAccess<B::Status::unused_0>());
+	CHECK(fieldAccess<B::Status::nRDY>());
+	CHECK(fieldAccess<C::FAULT_QUEUE>());
+	CHECK(fieldAccess<C::CT_PIN_POLARITY>());
+	CHECK(fieldAccess<C::INT_PIN_POLARITY>());
+	CHECK(fieldAccess<C::INT_CT_MODE>());
+	CHECK(fieldAccess<C::OPMODE>());
+	CHECK(fieldAccess<C::RESOLUTION>());
+	CHECK(fieldAccess<B::THIGH::THIGH_>());
+	CHECK(fieldAccess<B::THYST::HYSTERESIS>());
+	CHECK(fieldAccess<B::ID::REVISION_ID>());
+	CHECK(fieldAccess<B::ID::MANUFACTURER_ID>());
+
+	/* Decoded examples */
+	CHECK(B::get<B::ID::MANUFACTURER_ID>(ADT7410_Sim::ID_VALUE) == B::ID::MANUFACTURER_ID::dflt);
+	CHECK(B::get<B::ID::REVISION_ID>(ADT7410_Sim::ID_VALUE) == 3);
+	CHECK(B::get<C::OPMODE>(0x60) == C::OPMODE::SHUTDOWB);
+	CHECK(B::set<C::RESOLUTION>(0x60, C::RESOLUTION::RES_16_BIT) == 0xE0);
+
+	/* A multi-field update equals the single updates in order, the last value of a field wins */
+	B::Modify m = B::modify<C::OPMODE>(C::OPMODE::ONE_SPS)
+		.set<C::RESOLUTION>(C::RESOLUTION::RES_16_BIT)
+		.set<C::FAULT_QUEUE>(C::FAULT_QUEUE::FAULTS_4)
+		.set<C::OPMODE>(C::OPMODE::ONE_SHOT);
+	CHECK(m.getMask() == (C::OPMODE::mask | C::RESOLUTION::mask | C::FAULT_QUEUE::mask));
+	bool same = true;
+	for (uint16_t raw = 0; raw < 0x100; raw++)
+	{
+		uint16_t single = B::set<C::OPMODE>(raw, C::OPMODE::ONE_SHOT);
+		single = B::set<C::RESOLUTION>(single, C::RESOLUTION::RES_16_BIT);
+		single = B::set<C::FAULT_QUEUE>(single, C::FAULT_QUEUE::FAULTS_4);
+		same = same && m.apply(raw) == single && (m.apply(raw) & m.getMask()) == m.getBits();
+	}
+	CHECK(same);
+	CHECK(B::Modify().apply(0x5A) == 0x5A && B::Modify().getMask() == 0);
+
+	/* modifyConfiguration(): one read and one write */
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	sim.setConfiguration(0x1C);
+	uint64_t before = sim.getTransactions();
+	sim.modifyConfiguration(B::modify<C::OPMODE>(C::OPMODE::SHUTDOWB).set<C::RESOLUTION>(C::RESOLUTION::RES_16_BIT));
+	CHECK(sim.getTransactions() == before + 2);
+	CHECK(sim.getConfiguration() == 0xFC);
+}
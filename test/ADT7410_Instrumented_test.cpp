@@ -0,0 +1,96 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Instrumented_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Instrumented.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+typedef ADT7410_Base B;
+typedef ADT7410_TransactionStats S;
+
+/* Occurrences of text in out */
+static int occurrences(const std::string &out, const char *text)
+{
+	int n = 0;
+	for (size_t at = out.find(text); at != std::string::npos; at = out.find(text, at + 1))
+		n++;
+	return n;
+}
+
+/* Value of the sample line starting with series, -1 if there is none */
+static double sampleValue(const std::string &out, const char *series)
+{
+	size_t at = out.find(series);
+	if (at == std::string::npos)
+		return -1;
+	return atof(out.c_str() + out.find(' ', at) + 1);
+}
+
+void testInstrumented()
+{
+	/* Durations are taken on the monotonic clock, so the simulator sleeps its latency */
+	ADT7410_Sim sim(0, 1);
+	ADT7410_Instrumented device(sim);
+
+	device.getTEMPERATURE();
+	device.readSnapshot();
+	device.setConfiguration(0x80);
+	device.setRESET();
+	sim.setLatency(2000000);
+	device.setTHIGH(0x1000);
+	sim.setLatency(0);
+	sim.setErrorRate(1);
+	device.getID();
+	sim.setErrorRate(0);
+
+	S stats = device.getStats();
+	const S::Entry &temperature = stats.entries[0][S::READ];
+	CHECK(temperature.count == 2 && temperature.bytes == 6);
+	CHECK(stats.entries[B::Configuration::__address][S::WRITE].bytes == 1);
+	CHECK(stats.entries[S::RESET_SLOT][S::WRITE].count == 1 && stats.entries[S::RESET_SLOT][S::WRITE].bytes == 0);
+	const S::Entry &id = stats.entries[B::ID::__address][S::READ];
+	CHECK(id.count == 1 && id.errors == 1 && id.nacks == 1);
+	CHECK(stats.entries[B::Status::__address][S::READ].count == 0);
+
+	/* max: the slow write and only that */
+	const S::Entry &thigh = stats.entries[B::THIGH::__address][S::WRITE];
+	CHECK(thigh.max >= 2000000 && thigh.max == thigh.total);
+	CHECK(temperature.max < 2000000 && temperature.max <= temperature.total);
+	uint64_t counted = 0;
+	for (int b = 0; b < S::BUCKETS; b++)
+		counted += thigh.buckets[b];
+	CHECK(counted == 1 && thigh.buckets[20] + thigh.buckets[21] + thigh.buckets[22] == 1);
+
+	/* Exposition: the gauge next to the histogram, one header per metric over several devices */
+	S stats2[2] = { stats, stats };
+	const char *labels[2] = { "device=\"0\"", "device=\"1\"" };
+	std::string out = S::toPrometheus(stats2, labels, 2);
+	CHECK(occurrences(out, "# TYPE adt7410_transaction_duration_max_seconds gauge\n") == 1);
+	CHECK(occurrences(out, "# TYPE adt7410_transaction_duration_seconds histogram\n") == 1);
+	CHECK(occurrences(out, "# TYPE ") == S::METRICS);
+	double max = sampleValue(out, "adt7410_transaction_duration_max_seconds{register=\"THIGH\",direction=\"write\",device=\"1\"}");
+	CHECK(max >= 0.002 && max < 1);
+	CHECK(occurrences(out, "adt7410_transaction_duration_max_seconds{") == 2 * 5);
+	CHECK(occurrences(out, "adt7410_transaction_duration_seconds_bucket{register=\"TEMPERATURE\",direction=\"read\",device=\"0\"") == S::BUCKETS);
+	CHECK(sampleValue(out, "adt7410_nacks_total{register=\"ID\",direction=\"read\",device=\"0\"}") == 1);
+
+	/* Disabled: forwarded, not recorded; reset clears max with the rest */
+	device.setEnabled(false);
+	device.getTEMPERATURE();
+	CHECK(device.getStats().entries[0][S::READ].count == 2);
+	device.resetStats();
+	CHECK(device.getStats().entries[B::THIGH::__address][S::WRITE].max == 0);
+	CHECK(device.getStats().toPrometheus().find("adt7410_transaction_duration_max_seconds{") == std::string::npos);
+}
@@ -0,0 +1,162 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Log_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Log.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+typedef ADT7410_Base::Configuration C;
+
+/* Samples of a few simulated devices, one conversion apart, with resolution and Status changes */
+static std::vector<ADT7410_Sample> simulatedSamples(size_t devices, size_t rounds)
+{
+	ADT7410_SimClock clock(true);
+	std::vector<ADT7410_Sim *> sims;
+	for (size_t d = 0; d < devices; d++)
+	{
+		sims.push_back(new ADT7410_Sim(&clock, uint32_t(d + 1)));
+		sims[d]->setTemperature(int32_t(20 * 128 + d * 300));
+	}
+	clock.advance(ADT7410_Base::RESET_TIME);
+
+	std::vector<ADT7410_Sample> samples;
+	for (size_t r = 0; r < rounds; r++)
+	{
+		if (r == rounds / 2)
+			sims[0]->setConfiguration(uint8_t(ADT7410_Base::set<C::RESOLUTION>(0, C::RESOLUTION::RES_16_BIT)));
+		clock.advance(ADT7410_Base::CONVERSION_TIME);
+		for (size_t d = 0; d < devices; d++)
+		{
+			sims[d]->setTemperature(int32_t(20 * 128 + d * 300 + (r % 50) * 7 - int(r % 3) * 11));
+			ADT7410_Base::Snapshot snapshot = sims[d]->readSnapshot();
+			ADT7410_Sample s;
+			s.timestamp = clock.now();
+			s.device = uint16_t(d);
+			s.temperature = snapshot.temperature;
+			s.status = snapshot.status;
+			s.configuration = snapshot.configuration;
+			samples.push_back(s);
+		}
+	}
+	for (size_t d = 0; d < devices; d++)
+		delete sims[d];
+	return samples;
+}
+
+/* Chunk epochs are taken per chunk, so the wall-clock times of one boot may differ by this much */
+static const uint64_t EPOCH_JITTER = 1000000;
+
+static bool near(uint64_t a, uint64_t b)
+{
+	return (a > b ? a - b : b - a) <= EPOCH_JITTER;
+}
+
+static std::string temporaryPath(const char *name)
+{
+	const char *directory = getenv("TMPDIR");
+	char path[256];
+	snprintf(path, sizeof(path), "%s/%s.%ld", directory && *directory ? directory : "/tmp", name, long(getpid()));
+	return path;
+}
+
+/* The log keeps Status and only the RESOLUTION bit of Configuration */
+static bool sameLogged(const ADT7410_Sample &a, const ADT7410_Sample &b)
+{
+	return a.device == b.device && a.temperature == b.temperature && a.status == b.status
+		&& (a.configuration & C::RESOLUTION::mask) == (b.configuration & C::RESOLUTION::mask);
+}
+
+void testLog()
+{
+	std::vector<ADT7410_Sample> samples = simulatedSamples(4, 400);
+	std::string path = temporaryPath("ADT7410_test.log");
+	unlink(path.c_str());
+
+	/* Written in two sessions, small chunks */
+	ADT7410_LogWriter writer;
+	CHECK(writer.open(path.c_str(), 256));
+	CHECK(writer.append(&samples[0], samples.size() / 2));
+	writer.close();
+	CHECK(writer.open(path.c_str(), 256));
+	CHECK(writer.append(&samples[samples.size() / 2], samples.size() - samples.size() / 2));
+	writer.close();
+
+	/* Round trip: identical content, timestamps moved by the chunk epoch */
+	ADT7410_LogReader reader;
+	CHECK(reader.open(path.c_str()));
+	const std::vector<ADT7410_LogReader::Chunk> &chunks = reader.getChunks();
+	CHECK(chunks.size() > 10);
+	int64_t epoch = chunks.empty() ? 0 : chunks[0].epoch;
+	std::vector<ADT7410_Sample> read(samples.size() + 1);
+	size_t n = reader.read(&read[0], read.size());
+	CHECK(n == samples.size());
+	bool same = n == samples.size();
+	for (size_t i = 0; same && i < n; i++)
+		same = sameLogged(read[i], samples[i]) && near(read[i].timestamp, uint64_t(int64_t(samples[i].timestamp) + epoch));
+	CHECK(same);
+
+	/* Chunk headers bound their samples */
+	bool bounded = true;
+	for (size_t i = 1; i < chunks.size(); i++)
+		bounded = bounded && chunks[i - 1].first <= chunks[i - 1].last
+			&& (chunks[i - 1].last <= chunks[i].first || near(chunks[i - 1].last, chunks[i].first));
+	CHECK(bounded);
+
+	/* seek() selects a half-open wall-clock range */
+	uint64_t begin = read[samples.size() / 3].timestamp;
+	uint64_t end = read[2 * samples.size() / 3].timestamp;
+	size_t inside = 0;
+	for (size_t i = 0; i < n; i++)
+		inside += read[i].timestamp >= begin && read[i].timestamp < end;
+	reader.seek(begin, end);
+	size_t found = reader.read(&read[0], read.size());
+	CHECK(found == inside);
+	CHECK(found && read[0].timestamp == begin);
+
+	/* readRaw() stops at a resolution change */
+	reader.seek(0);
+	uint16_t raw[4096];
+	uint16_t device[4096];
+	bool res16 = false;
+	size_t words = reader.readRaw(raw, device, 0, 4096, res16);
+	CHECK(!res16);
+	CHECK(words > 0 && words < samples.size());
+	CHECK(words && raw[0] == samples[0].temperature && device[words - 1] == samples[words - 1].device);
+	size_t more = reader.readRaw(raw, device, 0, 4096, res16);
+	CHECK(more > 0 && res16 && raw[0] == samples[words].temperature);
+	reader.close();
+
+	/* A chunk torn by a crash is cut off on the next open, appending continues behind it */
+	FILE *file = fopen(path.c_str(), "ab");
+	CHECK(file != 0);
+	if (file)
+	{
+		static const uint8_t torn[] = { 'C', 'H', 'N', 'K', 0xFF, 0x00, 0x00, 0x00, 0x05 };
+		fwrite(torn, 1, sizeof(torn), file);
+		fclose(file);
+	}
+	CHECK(writer.open(path.c_str(), 256));
+	ADT7410_Sample last = ADT7410_makeSample(7, 0x1234, samples.back().timestamp + 1000);
+	CHECK(writer.append(last));
+	writer.close();
+	CHECK(reader.open(path.c_str()));
+	n = reader.read(&read[0], read.size());
+	CHECK(n == samples.size() + 1);
+	CHECK(n && read[n - 1].device == 7 && read[n - 1].temperature == 0x1234);
+	reader.close();
+	unlink(path.c_str());
+}
@@ -0,0 +1,82 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Profile_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Profile.hpp"
+#include "ADT7410_Sim.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+static void noSleep(uint64_t, void *)
+{
+}
+
+void testProfile()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	sim.setTemperature(25 * 128);
+
+	/* A fresh device holds the defaults; the snapshot is one block read */
+	ADT7410_Profile current;
+	uint64_t before = sim.getTransactions();
+	CHECK(current.snapshot(sim) == ADT7410_Profile::OK);
+	CHECK(sim.getTransactions() - before == 1);
+	CHECK(current == ADT7410_Profile::defaults());
+
+	/* apply() writes only the registers that differ, Configuration last */
+	ADT7410_Profile profile = ADT7410_Profile::defaults();
+	profile.thigh = 30 * 128;
+	profile.configuration = uint8_t(B::set<C::RESOLUTION>(0, C::RESOLUTION::RES_16_BIT));
+	uint8_t written = 0xFF;
+	before = sim.getTransactions();
+	CHECK(profile.apply(sim, true, &written) == ADT7410_Profile::OK);
+	CHECK(written == (ADT7410_Profile::THIGH | ADT7410_Profile::CONFIGURATION));
+	CHECK(sim.getTransactions() - before == 4);
+	CHECK(sim.getTHIGH() == 30 * 128 && sim.getConfiguration() == profile.configuration);
+
+	/* Applying it again reads and writes nothing else */
+	before = sim.getTransactions();
+	CHECK(profile.apply(sim, true, &written) == ADT7410_Profile::OK);
+	CHECK(written == 0 && sim.getTransactions() - before == 1);
+
+	/* A one-shot profile always writes Configuration; verification accepts the return to shutdown */
+	ADT7410_Profile one_shot = profile;
+	one_shot.configuration = uint8_t(B::set<C::OPMODE>(profile.configuration, C::OPMODE::ONE_SHOT));
+	CHECK(one_shot.apply(sim, true, &written) == ADT7410_Profile::OK);
+	CHECK(written == ADT7410_Profile::CONFIGURATION);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::SHUTDOWB);
+	CHECK(one_shot.apply(sim, true, &written) == ADT7410_Profile::OK);
+	CHECK(written == ADT7410_Profile::CONFIGURATION);
+
+	/* restore() waits out the RESET on the clock it is given, then writes everything that is not a default */
+	uint64_t reset_at = clock.now();
+	CHECK(profile.restore(sim, true, &written, ADT7410_SimClock::sleepHook, &clock) == ADT7410_Profile::OK);
+	CHECK(clock.now() - reset_at == B::RESET_TIME);
+	CHECK(written == (ADT7410_Profile::THIGH | ADT7410_Profile::CONFIGURATION));
+	CHECK(current.snapshot(sim) == ADT7410_Profile::OK && current == profile);
+
+	/* Without the wait the device is still NACKing, and comes back with the defaults */
+	CHECK(profile.restore(sim, true, &written, noSleep, 0) == ADT7410_Profile::BUS_ERROR);
+	CHECK(written == 0);
+	clock.advance(B::RESET_TIME);
+	CHECK(current.snapshot(sim) == ADT7410_Profile::OK && current == ADT7410_Profile::defaults());
+	CHECK(profile.applyAfterReset(sim, true, &written) == ADT7410_Profile::OK);
+
+	/* A failed write stops apply(): nothing is reported written */
+	sim.setErrorRate(1);
+	CHECK(ADT7410_Profile::defaults().apply(sim, profile, false, &written) == ADT7410_Profile::BUS_ERROR);
+	CHECK(written == 0);
+	sim.setErrorRate(0);
+	CHECK(current.snapshot(sim) == ADT7410_Profile::OK && current == profile);
+}
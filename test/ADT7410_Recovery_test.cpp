@@ -0,0 +1,99 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Recovery_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Recovery.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+
+typedef ADT7410_Base B;
+
+static const uint64_t MICROSECOND = 1000;
+static const uint64_t MILLISECOND = 1000000;
+
+/* Read THYST through the recovery layer; transactions receives the bus transactions the call issued */
+static int readTHYST(ADT7410_Recovery &recovery, ADT7410_Sim &sim, uint64_t deadline, uint64_t &transactions)
+{
+	uint64_t before = sim.getTransactions();
+	uint8_t value = 0;
+	int e = recovery.read8(0, B::THYST::__address, value, deadline);
+	transactions = sim.getTransactions() - before;
+	if (!e)
+		CHECK(value == 0x05);
+	return e;
+}
+
+void testRecovery()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	ADT7410_Recovery recovery;
+	recovery.setClock(ADT7410_SimClock::nowHook, &clock);
+	CHECK(recovery.addDevice(sim) == 0);
+	const uint64_t far = 1000 * MILLISECOND;
+	uint64_t transactions = 0;
+
+	/* Healthy: one transaction */
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == 0 && transactions == 1);
+	CHECK(recovery.getState(0) == ADT7410_Recovery::HEALTHY);
+
+	/* Retries after a doubling backoff; early calls are refused without bus access */
+	sim.setErrorRate(1);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 1);
+	CHECK(recovery.getRetryAt(0) == clock.now() + 100 * MICROSECOND);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 0);
+	clock.advance(100 * MICROSECOND);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 1);
+	CHECK(recovery.getRetryAt(0) == clock.now() + 200 * MICROSECOND);
+	clock.advance(200 * MICROSECOND);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == ENXIO && transactions == 1);
+	CHECK(recovery.getState(0) == ADT7410_Recovery::FAILING);
+	ADT7410_Recovery::Stats stats = recovery.getStats(0);
+	CHECK(stats.retries == 2 && stats.gaveUp == 1 && stats.rejected == 1 && stats.failures == 3);
+
+	/* No retry that would end after the deadline */
+	CHECK(readTHYST(recovery, sim, clock.now() + 50 * MICROSECOND, transactions) == ENXIO && transactions == 1);
+
+	/* A third failed call quarantines the device */
+	CHECK(readTHYST(recovery, sim, clock.now(), transactions) == ENXIO);
+	CHECK(recovery.getState(0) == ADT7410_Recovery::QUARANTINED && recovery.isQuarantined(0, clock.now()));
+	CHECK(recovery.getQuarantineEnd(0) == clock.now() + 100 * MILLISECOND);
+	clock.advance(100 * MILLISECOND - 1);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 0);
+
+	/* A failed probe doubles the quarantine */
+	clock.advance(1);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == ENXIO && transactions == 1);
+	CHECK(recovery.getQuarantineEnd(0) == clock.now() + 200 * MILLISECOND);
+	CHECK(recovery.getStats(0).probeFailures == 1);
+
+	/* A successful probe ends the quarantine; the access is the next call's transaction */
+	sim.setErrorRate(0);
+	clock.advance(200 * MILLISECOND);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 1);
+	CHECK(recovery.getRetryAt(0) == clock.now() && !recovery.isQuarantined(0, clock.now()));
+	CHECK(recovery.getState(0) == ADT7410_Recovery::HEALTHY);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == 0 && transactions == 1);
+	stats = recovery.getStats(0);
+	CHECK(stats.probes == 2 && stats.quarantines == 1);
+	CHECK(stats.transactions == sim.getTransactions());
+
+	/* After RESET the device is left alone for RESET_TIME: EBUSY if the deadline is earlier, else EAGAIN */
+	CHECK(recovery.reset(0, clock.now() + far) == 0);
+	CHECK(readTHYST(recovery, sim, clock.now() + B::RESET_TIME - 1, transactions) == EBUSY && transactions == 0);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == EAGAIN && transactions == 0);
+	clock.advance(B::RESET_TIME);
+	CHECK(readTHYST(recovery, sim, clock.now() + far, transactions) == 0 && transactions == 1);
+	CHECK(recovery.getTotals().calls == recovery.getStats(0).calls);
+	uint8_t value = 0;
+	CHECK(recovery.read8(1, B::THYST::__address, value, far) == EINVAL);
+}
@@ -0,0 +1,88 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_RegisterMap_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_RegisterMap.hpp"
+#include "ADT7410_Sim.hpp"
+
+typedef ADT7410_Base B;
+typedef ADT7410_RegisterMap M;
+
+/* Whether plan() gives exactly the bursts listed as address, length pairs */
+static bool planned(uint32_t registers, size_t count, const uint16_t *expected)
+{
+	M::Burst bursts[M::BYTES];
+	if (M::plan(registers, bursts, M::BYTES) != count)
+		return false;
+	for (size_t i = 0; i < count; i++)
+		if (bursts[i].address != expected[2 * i] || bursts[i].length != expected[2 * i + 1])
+			return false;
+	return true;
+}
+
+void testRegisterMap()
+{
+	const uint32_t temperature = M::bit("TEMPERATURE"), status = M::bit("Status"), configuration = M::bit("Configuration");
+	const uint32_t thigh = M::bit("THIGH"), thyst = M::bit("THYST"), id = M::bit("ID");
+	CHECK(temperature && status && configuration && thigh && thyst && id && !M::bit("nonsense"));
+	CHECK(!(M::readable() & M::bit("RESET")));
+	CHECK(M::nonVolatile() == (M::readable() & ~(temperature | status)));
+
+	/* Everything in one block, the non-volatile registers in one block from Configuration on */
+	const uint16_t all[] = { 0, 12 };
+	CHECK(planned(M::readable(), 1, all));
+	const uint16_t settings[] = { 3, 9 };
+	CHECK(planned(M::nonVolatile(), 1, settings));
+
+	/* Gaps of non-volatile registers are bridged, an unrequested Status is not */
+	const uint16_t bridged[] = { 3, 9 };
+	CHECK(planned(configuration | id, 1, bridged));
+	const uint16_t split[] = { 0, 2, 3, 1 };
+	CHECK(planned(temperature | configuration, 2, split));
+	const uint16_t volatiles[] = { 0, 3 };
+	CHECK(planned(temperature | status, 1, volatiles));
+	const uint16_t single[] = { 10, 1 };
+	CHECK(planned(thyst, 1, single));
+	CHECK(planned(0, 0, 0));
+
+	/* The count is complete even where the bursts do not fit */
+	M::Burst one[1];
+	CHECK(M::plan(temperature | configuration, one, 1) == 2 && one[0].address == 0 && one[0].length == 2);
+
+	/* Reading the settings does not touch nRDY; registers read on the way are valid too */
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	sim.setTemperature(25 * 128);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(!(sim.getStatus() & B::Status::nRDY::mask));
+	M map;
+	uint64_t before = sim.getTransactions();
+	CHECK(map.read(sim, configuration | id) == 0);
+	CHECK(sim.getTransactions() - before == 1);
+	CHECK(map.getValid() == M::nonVolatile());
+	CHECK(!(sim.getStatus() & B::Status::nRDY::mask));
+	CHECK(map.value(*ADT7410_findRegister("THIGH")) == sim.getTHIGH());
+	CHECK(map.value(*ADT7410_findRegister("ID")) == ADT7410_Sim::ID_VALUE);
+
+	/* A failed burst leaves its registers invalid */
+	sim.setErrorRate(1);
+	CHECK(map.read(sim, temperature | configuration) != 0);
+	CHECK(!(map.getValid() & (temperature | configuration)) && (map.getValid() & thigh));
+	sim.setErrorRate(0);
+
+	/* Differences per register and per field */
+	M other = map;
+	sim.setTHIGH(31 * 128);
+	CHECK(other.read(sim, thigh | thyst) == 0);
+	CHECK(map.differing(other, M::readable()) == thigh);
+	CHECK(map.diff(other, M::readable()).find("THIGH") != std::string::npos);
+	CHECK(map.diff(other, thyst).empty());
+}
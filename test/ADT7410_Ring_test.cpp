@@ -0,0 +1,79 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Ring_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+static const uint32_t RING_SAMPLES = 200000;
+
+/* Pushes refused by the full ring, retried by the producer */
+static uint32_t ring_refused = 0;
+
+static void *ringProducer(void *argument)
+{
+	ADT7410_SampleRing &ring = *static_cast<ADT7410_SampleRing *>(argument);
+	for (uint32_t i = 0; i < RING_SAMPLES; i++)
+		while (!ring.push(ADT7410_makeSample(uint16_t(i), uint16_t(i >> 16), i)))
+		{
+			ring_refused++;
+			sched_yield();
+		}
+	return 0;
+}
+
+void testRing()
+{
+	/* Capacity rounds up, DROP_NEWEST keeps the first samples */
+	ADT7410_SampleRing drop(5);
+	CHECK(drop.getCapacity() == 8);
+	int accepted = 0;
+	for (uint16_t i = 0; i < 10; i++)
+		accepted += drop.push(ADT7410_makeSample(i, 0, i));
+	CHECK(accepted == 8);
+	CHECK(drop.getDropped() == 2);
+	CHECK(drop.size() == 8);
+	ADT7410_Sample out[16];
+	CHECK(drop.pop(out, 16) == 8);
+	for (uint16_t i = 0; i < 8; i++)
+		CHECK(out[i].device == i);
+	CHECK(!drop.pop(out[0]));
+
+	/* OVERWRITE_OLDEST keeps the last samples */
+	ADT7410_SampleRing overwrite(8, ADT7410_SampleRing::OVERWRITE_OLDEST);
+	for (uint16_t i = 0; i < 10; i++)
+		CHECK(overwrite.push(ADT7410_makeSample(i, 0, i)));
+	CHECK(overwrite.getOverwritten() == 2);
+	CHECK(overwrite.pop(out, 16) == 8);
+	for (uint16_t i = 0; i < 8; i++)
+		CHECK(out[i].device == i + 2);
+
+	/* One producer and one consumer thread: every sample arrives once, in order */
+	ADT7410_SampleRing ring(64);
+	pthread_t producer;
+	pthread_create(&producer, 0, ringProducer, &ring);
+	uint32_t expected = 0;
+	bool ordered = true;
+	while (expected < RING_SAMPLES)
+	{
+		uint32_t n = ring.pop(out, 16);
+		for (uint32_t i = 0; i < n; i++, expected++)
+			if (out[i].timestamp != expected || out[i].device != uint16_t(expected) || out[i].temperature != uint16_t(expected >> 16))
+				ordered = false;
+		if (!n)
+			sched_yield();
+	}
+	pthread_join(producer, 0);
+	CHECK(ordered);
+	CHECK(ring.size() == 0);
+	CHECK(ring.getDropped() == ring_refused);
+}
@@ -0,0 +1,105 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sampler_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Sampler.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+void testSampler()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	sim.setTemperature(25 * 128);
+	ADT7410_Shadow shadow(sim);
+	ADT7410_Sampler sampler(shadow);
+	sampler.setClock(ADT7410_SimClock::nowHook, ADT7410_SimClock::sleepHook, &clock);
+
+	/* One-shot on a manual clock: one conversion time, the documented transactions plus the Configuration read */
+	ADT7410_Base::Snapshot snapshot = ADT7410_Base::Snapshot();
+	uint64_t begin = clock.now();
+	CHECK(sampler.sample(snapshot));
+	CHECK(clock.now() - begin == B::CONVERSION_TIME);
+	CHECK(sim.getTransactions() == 1 + ADT7410_Sampler::transactions(C::OPMODE::ONE_SHOT, false));
+	CHECK(snapshot.temperature == 0x0C80);
+	CHECK(B::get<C::OPMODE>(snapshot.configuration) == C::OPMODE::SHUTDOWB);
+	CHECK(sampler.getStats().samples == 1 && sampler.getStats().late == 0);
+
+	/* Later samples: each check that finds no result costs one Status read more */
+	uint64_t before = sim.getTransactions();
+	uint64_t checks = sampler.getStats().checks;
+	CHECK(sampler.sample(snapshot));
+	CHECK(sim.getTransactions() - before == ADT7410_Sampler::transactions(C::OPMODE::ONE_SHOT, false) + (sampler.getStats().checks - checks - 1));
+
+	/* The window is probed below the conversion time and settles just past it */
+	for (int i = 0; i < 200; i++)
+		sampler.sample(snapshot);
+	CHECK(sampler.getStats().samples == 202);
+	CHECK(sampler.getStats().late > 0);
+	CHECK(sampler.getWindow() >= B::CONVERSION_TIME / 2 && sampler.getWindow() <= B::CONVERSION_TIME + B::CONVERSION_TIME / 8);
+
+	sampler.setBurst(true);
+	before = sim.getTransactions();
+	checks = sampler.getStats().checks;
+	CHECK(sampler.sample(snapshot));
+	CHECK(sim.getTransactions() - before == ADT7410_Sampler::transactions(C::OPMODE::ONE_SHOT, true) + (sampler.getStats().checks - checks - 1));
+	sampler.setBurst(false);
+
+	/* A failed arming write ends the sample without waiting */
+	ADT7410_Sampler::Stats stats = sampler.getStats();
+	uint64_t window = sampler.getWindow();
+	sim.setErrorRate(1);
+	begin = clock.now();
+	CHECK(!sampler.sample(snapshot));
+	CHECK(sampler.error() == ENXIO);
+	CHECK(clock.now() == begin);
+	CHECK(sampler.getStats().errors == stats.errors + 1);
+	CHECK(sampler.getStats().samples == stats.samples && sampler.getStats().timeouts == stats.timeouts);
+	CHECK(sampler.getWindow() == window);
+	sim.setErrorRate(0);
+
+	/* Too short a timeout: no error, a timeout */
+	CHECK(!sampler.sample(snapshot, B::CONVERSION_TIME / 4));
+	CHECK(sampler.error() == 0);
+	CHECK(sampler.getStats().timeouts == stats.timeouts + 1);
+
+	/* Continuous: no arming once OPMODE is set, one Status and one TEMPERATURE read per sample */
+	ADT7410_Sampler continuous(shadow, C::OPMODE::CONTINOUS_CONVERSIO);
+	continuous.setClock(ADT7410_SimClock::nowHook, ADT7410_SimClock::sleepHook, &clock);
+	CHECK(continuous.sample(snapshot));
+	CHECK(continuous.sample(snapshot));
+	before = sim.getTransactions();
+	checks = continuous.getStats().checks;
+	begin = clock.now();
+	CHECK(continuous.sample(snapshot));
+	CHECK(sim.getTransactions() - before == ADT7410_Sampler::transactions(C::OPMODE::CONTINOUS_CONVERSIO, false) + (continuous.getStats().checks - checks - 1));
+	CHECK(clock.now() - begin <= B::CONVERSION_TIME + B::CONVERSION_TIME / 8);
+
+	/* A failed Status read is an error, not a ready result; the window keeps what it learned */
+	window = continuous.getWindow();
+	sim.setErrorRate(1);
+	CHECK(!continuous.sample(snapshot));
+	CHECK(continuous.error() == ENXIO);
+	CHECK(continuous.getStats().errors == 1 && continuous.getStats().samples == 3);
+	CHECK(continuous.getWindow() == window);
+
+	/* So is a failed snapshot read */
+	continuous.setBurst(true);
+	CHECK(!continuous.sample(snapshot));
+	CHECK(continuous.getStats().errors == 2);
+	sim.setErrorRate(0);
+	CHECK(continuous.sample(snapshot) && continuous.error() == 0);
+	CHECK(snapshot.temperature == 0x0C80);
+}
@@ -0,0 +1,88 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Shadow_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Shadow.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+void testShadow()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	ADT7410_Shadow shadow(sim);
+	shadow.setClock(ADT7410_SimClock::nowHook, &clock);
+
+	/* load() reads Configuration through ID in one block read, later reads are served from the shadow */
+	CHECK(shadow.load() == 0);
+	CHECK(shadow.getID() == ADT7410_Sim::ID_VALUE);
+	CHECK(shadow.getTHIGH() == B::THIGH::THIGH_::dflt);
+	CHECK(sim.getTransactions() == 1);
+	CHECK(shadow.getHits() == 2 && shadow.getMisses() == 1);
+
+	/* An unchanged field stays off the bus, a changed one costs one write */
+	CHECK(!shadow.set<C::RESOLUTION>(C::__address, C::RESOLUTION::RES_13_BIT));
+	CHECK(sim.getTransactions() == 1);
+	CHECK(shadow.set<C::RESOLUTION>(C::__address, C::RESOLUTION::RES_16_BIT));
+	CHECK(shadow.error() == 0);
+	CHECK(sim.getTransactions() == 2);
+	CHECK(B::get<C::RESOLUTION>(sim.getConfiguration()) == C::RESOLUTION::RES_16_BIT);
+
+	/* A failed read leaves the register unknown and nothing is written */
+	shadow.invalidate(B::THYST::__address);
+	sim.setErrorRate(1);
+	uint64_t before = sim.getTransactions();
+	CHECK(!shadow.set<B::THYST::HYSTERESIS>(B::THYST::__address, 10));
+	CHECK(shadow.error() == ENXIO);
+	CHECK(!shadow.isValid(B::THYST::__address));
+	CHECK(sim.getTransactions() == before + 1);
+
+	/* A failed write forgets the register, so the same write is not skipped later */
+	CHECK(shadow.setTHIGH(0x1000) == ENXIO);
+	CHECK(!shadow.isValid(B::THIGH::__address));
+	sim.setErrorRate(0);
+	CHECK(shadow.getTHIGH() == B::THIGH::THIGH_::dflt);
+	CHECK(shadow.set<B::THIGH::THIGH_>(B::THIGH::__address, 0x1000));
+	CHECK(sim.getTHIGH() == 0x1000);
+
+	/* One-shot is shadowed as written while the conversion runs */
+	uint8_t one_shot = uint8_t(B::set<C::OPMODE>(shadow.getConfiguration(), C::OPMODE::ONE_SHOT));
+	CHECK(shadow.setConfiguration(one_shot) == 0);
+	clock.advance(B::CONVERSION_TIME / 2);
+	CHECK(shadow.get<C::OPMODE>(C::__address) == C::OPMODE::ONE_SHOT);
+
+	/* A modify of another field during the conversion restarts it instead of shutting the device down */
+	uint64_t conversions = sim.getConversions();
+	CHECK(shadow.set<C::RESOLUTION>(C::__address, C::RESOLUTION::RES_13_BIT));
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::ONE_SHOT);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::SHUTDOWB);
+	CHECK(sim.getConversions() == conversions + 1);
+
+	/* Afterwards the shadow holds shutdown, so one-shot is written again */
+	before = sim.getTransactions();
+	CHECK(shadow.get<C::OPMODE>(C::__address) == C::OPMODE::SHUTDOWB);
+	CHECK(sim.getTransactions() == before);
+	CHECK(shadow.set<C::OPMODE>(C::__address, C::OPMODE::ONE_SHOT));
+	CHECK(sim.getTransactions() == before + 1);
+
+	/* reset() reseeds the defaults and keeps the ID */
+	shadow.reset();
+	CHECK(shadow.error() == 0);
+	before = sim.getTransactions();
+	CHECK(shadow.getConfiguration() == 0 && shadow.getTHIGH() == B::THIGH::THIGH_::dflt);
+	CHECK(shadow.getID() == ADT7410_Sim::ID_VALUE);
+	CHECK(sim.getTransactions() == before);
+}
@@ -0,0 +1,85 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_SharedTable_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_SharedTable.hpp"
+
+#include <pthread.h>
+
+static const uint32_t TABLE_UPDATES = 200000;
+
+/* Publishes entry 1 with values whose halves must match, see testTable() */
+static void *tableWriter(void *argument)
+{
+	ADT7410_SharedTable &table = *static_cast<ADT7410_SharedTable *>(argument);
+	for (uint32_t i = 1; i <= TABLE_UPDATES; i++)
+	{
+		ADT7410_Sample s = ADT7410_makeSample(1, uint16_t(i), (uint64_t(i) << 32) | i);
+		s.status = uint8_t(i);
+		s.configuration = uint8_t(i >> 8);
+		table.publish(s);
+	}
+	return 0;
+}
+
+void testTable()
+{
+	ADT7410_SharedTable table;
+	CHECK(table.create(4));
+	CHECK(table.isWritable() && table.size() == 4);
+
+	/* A second, read-only mapping of the same memfd sees the published entries */
+	ADT7410_SharedTable reader;
+	CHECK(reader.open(table.getFd()));
+	CHECK(!reader.isWritable() && reader.size() == 4);
+
+	ADT7410_Sample s;
+	CHECK(!reader.read(0, s));
+	ADT7410_Base::Snapshot snapshot;
+	snapshot.temperature = 0x0C80;
+	snapshot.status = 0x10;
+	snapshot.configuration = 0x80;
+	table.sample(0, snapshot, 12345);
+	CHECK(reader.read(0, s));
+	CHECK(s.device == 0 && s.temperature == 0x0C80 && s.status == 0x10 && s.configuration == 0x80 && s.timestamp == 12345);
+	CHECK(reader.getUpdates(0) == 1);
+
+	/* Out of range and read-only publishes are ignored */
+	table.publish(ADT7410_makeSample(9, 1, 1));
+	reader.publish(ADT7410_makeSample(2, 1, 1));
+	CHECK(!reader.read(2, s));
+	ADT7410_Sample all[4];
+	CHECK(reader.readAll(all, 4) == 1);
+
+	/* A reader racing the writer never sees an entry with fields of different updates */
+	pthread_t writer;
+	pthread_create(&writer, 0, tableWriter, &table);
+	uint32_t reads = 0, consistent = 0;
+	uint32_t previous = 0;
+	bool monotonic = true;
+	while (reader.getUpdates(1) < TABLE_UPDATES)
+	{
+		if (!reader.read(1, s))
+			continue;
+		uint32_t i = uint32_t(s.timestamp);
+		reads++;
+		consistent += uint32_t(s.timestamp >> 32) == i && s.temperature == uint16_t(i)
+			&& s.status == uint8_t(i) && s.configuration == uint8_t(i >> 8);
+		monotonic = monotonic && i >= previous;
+		previous = i;
+	}
+	pthread_join(writer, 0);
+	CHECK(reads == consistent);
+	CHECK(monotonic);
+	CHECK(reader.read(1, s) && s.timestamp == ((uint64_t(TABLE_UPDATES) << 32) | TABLE_UPDATES));
+	reader.close();
+	table.close();
+}
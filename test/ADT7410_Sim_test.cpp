@@ -0,0 +1,129 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Sim_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Alarm.hpp"
+#include "ADT7410_Sim.hpp"
+
+#include <cerrno>
+
+typedef ADT7410_Base B;
+typedef ADT7410_Base::Configuration C;
+
+void testSim()
+{
+	ADT7410_SimClock clock(true);
+	ADT7410_Sim sim(&clock, 1);
+	sim.setTemperature(25 * 128);
+
+	/* Power-on state: the register defaults, no result yet. Devices update lazily, on their next transaction */
+	CHECK(sim.getConfiguration() == 0);
+	CHECK(sim.getTHIGH() == B::THIGH::THIGH_::dflt && sim.getTLOW() == B::TLOW::TLOW_::dflt);
+	CHECK(sim.getTCRIT() == B::TCRIT::TCRIT_::dflt && sim.getTHYST() == 0x05);
+	CHECK(sim.getID() == ADT7410_Sim::ID_VALUE);
+	CHECK(sim.getStatus() & B::Status::nRDY::mask);
+
+	/* Continuous: a result every CONVERSION_TIME, nRDY reset by the TEMPERATURE read */
+	clock.advance(B::CONVERSION_TIME - 1);
+	CHECK(sim.getConversions() == 0 && (sim.getStatus() & B::Status::nRDY::mask));
+	clock.advance(1);
+	CHECK(!(sim.getStatus() & B::Status::nRDY::mask));
+	CHECK(sim.getTEMPERATURE() == 0x0C80);
+	CHECK(sim.getStatus() & B::Status::nRDY::mask);
+	clock.advance(10 * B::CONVERSION_TIME);
+	sim.getStatus();
+	CHECK(sim.getConversions() == 11);
+
+	/* 16-bit resolution keeps the fraction the 13-bit word drops */
+	sim.setTemperature(25 * 128 + 5);
+	sim.setConfiguration(uint8_t(B::set<C::RESOLUTION>(0, C::RESOLUTION::RES_16_BIT)));
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(sim.getTEMPERATURE() == 25 * 128 + 5);
+
+	/* One-shot: one conversion, then shutdown */
+	uint64_t conversions = sim.getConversions();
+	sim.setConfiguration(uint8_t(B::set<C::OPMODE>(0, C::OPMODE::ONE_SHOT)));
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::ONE_SHOT);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(B::get<C::OPMODE>(sim.getConfiguration()) == C::OPMODE::SHUTDOWB);
+	clock.advance(10 * B::CONVERSION_TIME);
+	CHECK(sim.getConversions() == conversions + 1);
+
+	/* 1 SPS: a 60 ms conversion once per second */
+	conversions = sim.getConversions();
+	sim.setConfiguration(uint8_t(B::set<C::OPMODE>(0, C::OPMODE::ONE_SPS)));
+	clock.advance(B::ONE_SPS_CONVERSION_TIME);
+	sim.getStatus();
+	CHECK(sim.getConversions() == conversions + 1);
+	clock.advance(3 * B::ONE_SPS_PERIOD);
+	sim.getStatus();
+	CHECK(sim.getConversions() == conversions + 4);
+
+	/* THIGH in interrupt mode: the flag clears on the Status read, INT (active low) asserts */
+	sim.setConfiguration(0);
+	sim.setTemperature(70 * 128);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(!sim.getINT());
+	uint8_t status = sim.getStatus();
+	CHECK(status & ADT7410_AlarmLogic::THIGH);
+	CHECK(!(status & (ADT7410_AlarmLogic::TLOW | ADT7410_AlarmLogic::TCRIT)));
+	CHECK(sim.getINT());
+	CHECK(!(sim.getStatus() & ADT7410_AlarmLogic::THIGH));
+
+	/* TCRIT drives CT in comparator fashion, with the THYST hysteresis */
+	CHECK(sim.getCT());
+	sim.setTemperature(150 * 128);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(!sim.getCT());
+	sim.setTemperature(147 * 128 + 64);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(!sim.getCT());
+	sim.setTemperature(140 * 128);
+	clock.advance(B::CONVERSION_TIME);
+	CHECK(sim.getCT());
+
+	/* RESET: everything is NACKed for RESET_TIME, then the defaults are back */
+	sim.setTHIGH(0x1000);
+	CHECK(sim.trySetRESET() == 0);
+	uint8_t id = 0;
+	CHECK(sim.tryRead8(B::ID::__address, id) == ENXIO);
+	clock.advance(B::RESET_TIME);
+	CHECK(sim.tryRead8(B::ID::__address, id) == 0 && id == ADT7410_Sim::ID_VALUE);
+	CHECK(sim.getTHIGH() == B::THIGH::THIGH_::dflt);
+
+	/* Injected NACKs have no side effects */
+	uint64_t nacks = sim.getNacks();
+	sim.setErrorRate(1);
+	CHECK(sim.tryWrite16(B::THIGH::__address, 0x1000) == ENXIO);
+	sim.setErrorRate(0);
+	CHECK(sim.getNacks() == nacks + 1);
+	CHECK(sim.getTHIGH() == B::THIGH::THIGH_::dflt);
+
+	/* A random rate NACKs about that share, the same ones for the same seed */
+	ADT7410_Sim a(&clock, 7), b(&clock, 7);
+	a.setErrorRate(0.25);
+	b.setErrorRate(0.25);
+	bool same = true;
+	for (int i = 0; i < 1000; i++)
+	{
+		a.getID();
+		b.getID();
+		same = same && a.error() == b.error();
+	}
+	CHECK(same);
+	CHECK(a.getNacks() > 150 && a.getNacks() < 350);
+
+	/* Latency advances a manual clock */
+	uint64_t before = clock.now();
+	sim.setLatency(100000);
+	sim.getID();
+	CHECK(clock.now() == before + 100000);
+}
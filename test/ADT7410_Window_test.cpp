@@ -0,0 +1,109 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_Window_test.cpp
+ */
+
+#include "ADT7410_test.hpp"
+#include "ADT7410_Window.hpp"
+
+#include <vector>
+
+class Summaries : public ADT7410_WindowSink
+{
+public:
+	void summary(const ADT7410_WindowSummary &summary)
+	{
+		all.push_back(summary);
+	}
+
+	std::vector<ADT7410_WindowSummary> all;
+};
+
+static const uint64_t SECOND = 1000000000u;
+static const uint64_t MILLISECOND = 1000000u;
+
+void testWindow()
+{
+	/* Tumbling 1 s windows: samples every 100 ms, temperature 0, 1, 2, ... in 1/128 °C */
+	Summaries tumbling;
+	ADT7410_Aggregator aggregator(tumbling, 2, SECOND);
+	CHECK(!aggregator.isSliding());
+	for (int i = 0; i < 15; i++)
+		aggregator.add(0, uint16_t(i * 128), true, SECOND + uint64_t(i) * 100 * MILLISECOND);
+	CHECK(tumbling.all.size() == 1);
+	if (tumbling.all.size() == 1)
+	{
+		const ADT7410_WindowSummary &w = tumbling.all[0];
+		CHECK(w.device == 0 && w.begin == SECOND && w.end == 2 * SECOND);
+		CHECK(w.count == 10);
+		CHECK(w.min == 0 && w.max == 9 * 128 && w.last == 9 * 128);
+		CHECK(w.mean == int16_t(4.5 * 128));
+		CHECK(w.rate > 9.99f && w.rate < 10.01f);  // 9 °C in 0.9 s
+	}
+	aggregator.add(0, uint16_t(100 * 128), true, 3 * SECOND + 100 * MILLISECOND);
+	CHECK(tumbling.all.size() == 2);
+
+	/* flush() emits the windows that ended, devices out of range are ignored */
+	aggregator.add(5, 0, true, 3 * SECOND);
+	aggregator.flush(5 * SECOND);
+	CHECK(tumbling.all.size() == 3);
+	if (tumbling.all.size() == 3)
+	{
+		CHECK(tumbling.all[1].count == 5 && tumbling.all[1].begin == 2 * SECOND);
+		CHECK(tumbling.all[2].count == 1 && tumbling.all[2].begin == 3 * SECOND && tumbling.all[2].rate == 0);
+	}
+
+	/* 13-bit words lose the flag bits */
+	Summaries flags;
+	ADT7410_Aggregator low(flags, 1, SECOND);
+	low.add(0, uint16_t(25 * 128 + 3), false, 0);
+	low.flush(SECOND);
+	CHECK(flags.all.size() == 1 && flags.all[0].max == 25 * 128);
+
+	/* Sliding 1 s windows every 250 ms, checked against a direct computation */
+	Summaries sliding;
+	ADT7410_Aggregator slider(sliding, 1, SECOND, 250 * MILLISECOND, 16);
+	CHECK(slider.isSliding());
+	for (int i = 0; i < 40; i++)
+	{
+		int16_t t = int16_t((i % 7) * 128 - 3 * 128);
+		slider.add(ADT7410_makeSample(0, uint16_t(t), uint64_t(i) * 100 * MILLISECOND));
+	}
+	CHECK(sliding.all.size() >= 12);
+	bool exact = true;
+	for (size_t k = 0; k < sliding.all.size(); k++)
+	{
+		const ADT7410_WindowSummary &w = sliding.all[k];
+		int16_t lo = 32767, hi = -32768;
+		uint32_t count = 0;
+		for (int i = 0; i < 40; i++)
+		{
+			uint64_t t = uint64_t(i) * 100 * MILLISECOND;
+			if (t < w.begin || t >= w.end)
+				continue;
+			int16_t v = int16_t((i % 7) * 128 - 3 * 128);
+			lo = v < lo ? v : lo;
+			hi = v > hi ? v : hi;
+			count++;
+		}
+		/* The first windows start at time 0 */
+		bool length = w.end - w.begin == SECOND || (w.begin == 0 && w.end < SECOND);
+		exact = exact && length && w.count == count && w.min == lo && w.max == hi;
+	}
+	CHECK(exact);
+	CHECK(slider.getOverflows() == 0);
+
+	/* A window holding more samples than the capacity drops the oldest */
+	Summaries small;
+	ADT7410_Aggregator crowded(small, 1, SECOND, 500 * MILLISECOND, 4);
+	for (int i = 0; i < 8; i++)
+		crowded.add(0, uint16_t(i * 128), true, uint64_t(i) * 10 * MILLISECOND);
+	crowded.flush(2 * SECOND);
+	CHECK(crowded.getOverflows() == 4);
+}
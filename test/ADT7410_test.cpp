@@ -0,0 +1,146 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_test.cpp
+ */
+
+/*
+ * Tests of the host-side modules, without hardware: samples come from the
+ * in-process simulator (ADT7410_Sim) on a manual clock, INT/CT lines from
+ * ADT7410_EventFdLines.
+ *   shadow       ADT7410_Shadow: hits, skipped writes, failed transactions, one-shot during the conversion
+ *   block        readBlock()/readSnapshot(): one transaction or per register, the first failure ends the block
+ *   sampler      ADT7410_Sampler: timing and transactions on a manual clock, failed transactions end a sample
+ *   fields       ADT7410_Registers field access: get/set against the masks, Modify, modifyConfiguration()
+ *   decode       ADT7410_decode(): the batch kernel against the scalar path on every word
+ *   ring         ADT7410_SampleRing: both full policies, one producer and one consumer thread
+ *   log          ADT7410_LogWriter/Reader: round trip, chunking, seek, readRaw, torn tail repair
+ *   sim          ADT7410_Sim: defaults, conversion timing per OPMODE, alarms and pins, RESET, injected NACKs
+ *   instrumented ADT7410_Instrumented: counts, errors, max and histogram, Prometheus exposition
+ *   device       ADT7410_Device<Transport>: the same accesses as through ADT7410_Base, errors included
+ *   async        ADT7410_AsyncBus/Device: one block read per snapshot, EDEADLK on the worker, EVENTFD dispatch
+ *   alarm        ADT7410_AlarmTable: the device's Status, INT and CT in every mode, batch updates
+ *   profile      ADT7410_Profile: only differing registers written, one-shot verification, restore on the simulated clock
+ *   window       ADT7410_Aggregator: tumbling and sliding summaries, flush
+ *   controller   ADT7410_Controller: promotion, demotion, budget, failed and avoided Configuration writes
+ *   recovery     ADT7410_Recovery: backoff, deadlines, quarantine and probe, RESET window; one transaction per call at most
+ *   table        ADT7410_SharedTable: publish/read through a second mapping, no torn entries
+ *   registermap  ADT7410_RegisterMap: plan() merges across non-volatile registers only, partial reads
+ *   events       ADT7410_AlarmEvents on ADT7410_EventFdLines: edge-driven reads, polarity check
+ * Every failed check is printed; the exit status is 1 if any failed.
+ *
+ * Build (from test/):
+ *   g++ -O2 -I.. -o ADT7410_test ADT7410_*test.cpp ../ADT7410_*.cpp -lpthread
+ * Run:
+ *   ./ADT7410_test [test ...]
+ */
+
+#include "ADT7410_test.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+static int checks = 0;
+static int failures = 0;
+
+bool ADT7410_check(bool condition, const char *text, const char *file, int line)
+{
+	checks++;
+	if (!condition)
+	{
+		failures++;
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+	}
+	return condition;
+}
+
+ADT7410_Sample ADT7410_makeSample(uint16_t device, uint16_t temperature, uint64_t timestamp)
+{
+	ADT7410_Sample s;
+	s.timestamp = timestamp;
+	s.device = device;
+	s.temperature = temperature;
+	s.status = 0;
+	s.configuration = 0;
+	return s;
+}
+
+struct Test
+{
+	const char *name;
+	void (*run)();
+};
+
+static const Test TESTS[] =
+{
+	{ "shadow", testShadow },
+	{ "block", testBlock },
+	{ "sampler", testSampler },
+	{ "fields", testFields },
+	{ "decode", testDecode },
+	{ "ring", testRing },
+	{ "log", testLog },
+	{ "sim", testSim },
+	{ "instrumented", testInstrumented },
+	{ "device", testDevice },
+	{ "async", testAsync },
+	{ "alarm", testAlarm },
+	{ "profile", testProfile },
+	{ "window", testWindow },
+	{ "controller", testController },
+	{ "recovery", testRecovery },
+	{ "table", testTable },
+	{ "registermap", testRegisterMap },
+	{ "events", testEvents },
+};
+
+static const size_t TEST_COUNT = sizeof(TESTS) / sizeof(TESTS[0]);
+
+static bool selected(const char *name, int argc, char **argv)
+{
+	if (argc < 2)
+		return true;
+	for (int i = 1; i < argc; i++)
+		if (!strcmp(argv[i], name))
+			return true;
+	return false;
+}
+
+static void usage(const char *program)
+{
+	fprintf(stderr, "usage: %s [test ...]\ntests:", program);
+	for (size_t t = 0; t < TEST_COUNT; t++)
+		fprintf(stderr, " %s", TESTS[t].name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		size_t t = 0;
+		while (t < TEST_COUNT && strcmp(argv[i], TESTS[t].name))
+			t++;
+		if (t == TEST_COUNT)
+		{
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	for (size_t t = 0; t < TEST_COUNT; t++)
+	{
+		if (!selected(TESTS[t].name, argc, argv))
+			continue;
+		int before = failures;
+		TESTS[t].run();
+		printf("%-14s %s\n", TESTS[t].name, failures == before ? "ok" : "FAILED");
+	}
+	printf("%d checks, %d failed\n", checks, failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * name:        ADT7410
+ * description: ±0.5°C Accurate, 16-Bit Digital I2C Temperature Sensor
+ * manuf:       Analog Devices
+ * version:     0.1
+ * url:         http://www.analog.com/media/en/technical-documentation/data-sheets/ADT7410.pdf
+ * date:        2017-12-28
+ * author       https://chisl.io/
+ * file:        ADT7410_test.hpp
+ */
+
+/*
+ * Shared by the test files: one ADT7410_<Module>_test.cpp per module defines
+ * its test function, main() in ADT7410_test.cpp runs them by name.
+ */
+
+#ifndef ADT7410_TEST_HPP
+#define ADT7410_TEST_HPP
+
+#include "ADT7410.hpp"
+#include "ADT7410_Ring.hpp"
+
+/* Count a check; print it with its location if the condition is false */
+#define CHECK(condition) ADT7410_check((condition), #condition, __FILE__, __LINE__)
+
+bool ADT7410_check(bool condition, const char *text, const char *file, int line);
+
+/* A sample with Status and Configuration 0 */
+ADT7410_Sample ADT7410_makeSample(uint16_t device, uint16_t temperature, uint64_t timestamp);
+
+/* The tests */
+void testShadow();
+void testBlock();
+void testSampler();
+void testFields();
+void testDecode();
+void testRing();
+void testLog();
+void testSim();
+void testInstrumented();
+void testDevice();
+void testAsync();
+void testAlarm();
+void testProfile();
+void testWindow();
+void testController();
+void testRecovery();
+void testTable();
+void testRegisterMap();
+void testEvents();
+
+#endif /* ADT7410_TEST_HPP */